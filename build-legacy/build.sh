@@ -9,9 +9,16 @@ if [ $# -ge 1 ]; then
 fi
 
 # Compile the program
-g++ -o legacy_shader src/main.cpp \
--I./include \
--lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32 -lSDL2_image
+if [ "$OS" = "Windows_NT" ]; then
+    g++ -o legacy_shader src/main.cpp \
+    -I./include \
+    -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32 -lSDL2_image
+else
+    # Linux / render farm build with the headless EGL backend (--headless or --backend egl)
+    g++ -std=c++14 -DLEGACY_WITH_EGL -o legacy_shader src/main.cpp \
+    -I./include \
+    -lSDL2 -lSDL2_image -lGLEW -lGL -lEGL -pthread
+fi
 
 # Check if compilation was successful
 if [ $? -eq 0 ]; then
@@ -0,0 +1,243 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include "shader_manager.h"
+
+#ifdef LEGACY_WITH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef LEGACY_WITH_OSMESA
+// glew.h undefines GLAPI and APIENTRY, which osmesa.h expects
+#ifndef GLAPI
+#define GLAPI extern
+#endif
+#ifndef APIENTRY
+#define APIENTRY GLAPIENTRY
+#endif
+#include "../../GL/osmesa.h"
+#endif
+
+// Rendering backend, set from the command line: "window" (default), "egl" or "osmesa".
+// The offscreen backends need no display; frames go into an FBO that stands in for the window.
+std::string backendName = "window";
+
+// Offscreen runs stop after this many frames and can save the last one as PPM
+int headlessFrames = 1;
+std::string outputPath = "";
+
+SDL_Window* backendWindow = nullptr;
+SDL_GLContext backendGlContext = nullptr;
+GLuint backendFramebuffer = 0;
+GLuint backendColorTexture = 0;
+#ifdef LEGACY_WITH_EGL
+EGLDisplay backendEglDisplay = EGL_NO_DISPLAY;
+EGLContext backendEglContext = EGL_NO_CONTEXT;
+#endif
+#ifdef LEGACY_WITH_OSMESA
+OSMesaContext backendOsMesaContext = nullptr;
+unsigned char backendOsMesaPixel[4];
+#endif
+
+bool backendIsHeadless() {
+  return backendName != "window";
+}
+
+// Function to create the SDL window and its context (core profile, compatibility fallback)
+bool initWindowBackend(const char* title) {
+  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
+    std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+    return false;
+  }
+  // Set OpenGL attributes - Request core profile for better compatibility with ES
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,
+                      3.3);  // At least OpenGL 3.3 for ES 3.0 compatibility
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+  // Create window with resizable flag
+  backendWindow = SDL_CreateWindow(
+      title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH,
+      WINDOW_HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+  // Check if window was created successfully
+  if (!backendWindow) {
+    std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+    return false;
+  }
+  // Create OpenGL context
+  backendGlContext = SDL_GL_CreateContext(backendWindow);
+  if (!backendGlContext) {
+    std::cerr << "OpenGL context could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+
+    // Try fallback to compatibility profile if core profile fails
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
+    backendGlContext = SDL_GL_CreateContext(backendWindow);
+    // Check if fallback context was created successfully
+    if (!backendGlContext) {
+      std::cerr << "Fallback OpenGL context could not be created! SDL_Error: " << SDL_GetError()
+                << std::endl;
+      return false;
+    }
+    std::cout << "Using compatibility profile as fallback" << std::endl;
+  }
+  return true;
+}
+
+#ifdef LEGACY_WITH_EGL
+// Function to create a surfaceless EGL context (EGL_MESA_platform_surfaceless)
+bool initEglBackend() {
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay) {
+    backendEglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (backendEglDisplay == EGL_NO_DISPLAY) {
+    backendEglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  if (backendEglDisplay == EGL_NO_DISPLAY || !eglInitialize(backendEglDisplay, nullptr, nullptr)) {
+    std::cerr << "EGL display could not be initialized!" << std::endl;
+    backendEglDisplay = EGL_NO_DISPLAY;
+    return false;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint contextAttributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  backendEglContext = eglCreateContext(backendEglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+  if (backendEglContext == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(backendEglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, backendEglContext)) {
+    std::cerr << "EGL context could not be created! EGL error: " << eglGetError() << std::endl;
+    return false;
+  }
+  return true;
+}
+#endif
+
+#ifdef LEGACY_WITH_OSMESA
+// Function to create an OSMesa software context (needs GLEW built with GLEW_OSMESA)
+bool initOsMesaBackend() {
+  const int attributes[] = {
+      OSMESA_FORMAT, OSMESA_RGBA,
+      OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+      OSMESA_CONTEXT_MAJOR_VERSION, 3,
+      OSMESA_CONTEXT_MINOR_VERSION, 3,
+      0};
+  backendOsMesaContext = OSMesaCreateContextAttribs(attributes, nullptr);
+  // The context's own buffer is a single pixel, frames go to the FBO
+  if (!backendOsMesaContext ||
+      !OSMesaMakeCurrent(backendOsMesaContext, backendOsMesaPixel, GL_UNSIGNED_BYTE, 1, 1)) {
+    std::cerr << "OSMesa context could not be created!" << std::endl;
+    return false;
+  }
+  return true;
+}
+#endif
+
+// Function to create the FBO that replaces the window in offscreen mode
+bool createBackendFramebuffer() {
+  glGenTextures(1, &backendColorTexture);
+  glBindTexture(GL_TEXTURE_2D, backendColorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glGenFramebuffers(1, &backendFramebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, backendFramebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, backendColorTexture, 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "ERROR::FRAMEBUFFER::INCOMPLETE" << std::endl;
+    return false;
+  }
+  // Stays bound: the renderer draws into it as if it were the window
+  return true;
+}
+
+// Function to create the context for the selected backend and initialize GLEW
+bool initBackend(const char* title) {
+  bool created = false;
+  if (backendName == "window") {
+    created = initWindowBackend(title);
+  } else if (backendName == "egl") {
+#ifdef LEGACY_WITH_EGL
+    created = initEglBackend();
+#else
+    std::cerr << "This build has no EGL backend (build with -DLEGACY_WITH_EGL -lEGL)" << std::endl;
+#endif
+  } else if (backendName == "osmesa") {
+#ifdef LEGACY_WITH_OSMESA
+    created = initOsMesaBackend();
+#else
+    std::cerr << "This build has no OSMesa backend (build with -DLEGACY_WITH_OSMESA -lOSMesa)" << std::endl;
+#endif
+  } else {
+    std::cerr << "Unknown backend: " << backendName << " (expected window, egl or osmesa)" << std::endl;
+  }
+  if (!created) {
+    return false;
+  }
+  if (backendIsHeadless()) {
+    // SDL is only used for timers without a window
+    SDL_Init(SDL_INIT_TIMER);
+  }
+  // Initialize GLEW
+  glewExperimental = GL_TRUE;
+  GLenum glewError = glewInit();
+  // A GLEW built for GLX reports a missing X display on headless contexts; the
+  // core entry points are loaded before that check
+  if (glewError == GLEW_ERROR_NO_GLX_DISPLAY && backendIsHeadless()) {
+    glewError = GLEW_OK;
+  }
+  if (glewError != GLEW_OK) {
+    std::cerr << "GLEW could not be initialized! Error: " << glewGetErrorString(glewError)
+              << std::endl;
+    return false;
+  }
+  while (glGetError() != GL_NO_ERROR) {
+  }
+  return !backendIsHeadless() || createBackendFramebuffer();
+}
+
+// Function to swap the window or flush the offscreen context
+void presentBackend() {
+  TRACE_SCOPE("present");
+  if (backendWindow) {
+    SDL_GL_SwapWindow(backendWindow);
+  } else {
+    glFlush();
+  }
+}
+
+// Function to destroy the context, FBO and window
+void shutdownBackend() {
+  if (backendFramebuffer != 0) {
+    glDeleteFramebuffers(1, &backendFramebuffer);
+    glDeleteTextures(1, &backendColorTexture);
+    backendFramebuffer = 0;
+  }
+#ifdef LEGACY_WITH_EGL
+  if (backendEglDisplay != EGL_NO_DISPLAY) {
+    eglMakeCurrent(backendEglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (backendEglContext != EGL_NO_CONTEXT) {
+      eglDestroyContext(backendEglDisplay, backendEglContext);
+    }
+    eglTerminate(backendEglDisplay);
+  }
+#endif
+#ifdef LEGACY_WITH_OSMESA
+  if (backendOsMesaContext) {
+    OSMesaDestroyContext(backendOsMesaContext);
+  }
+#endif
+  if (backendGlContext) {
+    SDL_GL_DeleteContext(backendGlContext);
+  }
+  if (backendWindow) {
+    SDL_DestroyWindow(backendWindow);
+  }
+  SDL_Quit();
+}
+
+#endif  // BACKEND_H
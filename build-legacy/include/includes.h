@@ -2,9 +2,9 @@
 #define INCLUDES_H
 
 // imports blyat 
-#include "..\..\SDL\SDL.h"
-#include <..\..\SDL\SDL_image.h> // Make sure to include SDL_image for texture loading
-#include "..\..\GL\glew.h"
+#include "../../SDL/SDL.h"
+#include <../../SDL/SDL_image.h> // Make sure to include SDL_image for texture loading
+#include "../../GL/glew.h"
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -0,0 +1,203 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include "backend.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Asynchronous screenshots / frame dumps: glReadPixels goes into a ring of pixel
+// buffer objects with a fence each, the PBOs are mapped a few frames later once the
+// fence has signalled, and a writer thread turns the pixels into PPM files.
+
+// Write every frame as <prefix>_NNNNNN.ppm (empty = off), set from the command line
+std::string dumpFramesPrefix = "";
+
+// PBOs in the ring: a readback is mapped up to this many frames after it was issued
+const int READBACK_RING_SIZE = 3;
+
+// Frames waiting for the writer thread; beyond this the render thread waits for it, so
+// a disk slower than the frame rate can't fill memory with frame copies
+const size_t READBACK_MAX_QUEUED = 8;
+
+struct ReadbackSlot {
+  GLuint pbo = 0;
+  GLsync fence = 0;
+  size_t capacity = 0;
+  int width = 0;
+  int height = 0;
+  std::string path;
+  std::string message;
+};
+
+// Pixels copied out of a PBO, waiting for the writer thread (bottom row first)
+struct ReadbackJob {
+  std::vector<unsigned char> pixels;
+  int width;
+  int height;
+  std::string path;
+  std::string message;  // Printed with the path once the file is written (empty = silent)
+};
+
+ReadbackSlot readbackSlots[READBACK_RING_SIZE];
+int readbackOldest = 0;
+int readbackCount = 0;
+
+std::deque<ReadbackJob> readbackQueue;
+std::mutex readbackMutex;
+std::condition_variable readbackCondition;
+std::thread readbackThread;
+bool readbackStopping = false;
+int readbackWriting = 0;
+
+// Writer thread: flips the rows and writes binary PPM files
+void readbackWriterLoop() {
+  std::unique_lock<std::mutex> lock(readbackMutex);
+  while (true) {
+    readbackCondition.wait(lock, [] { return readbackStopping || !readbackQueue.empty(); });
+    if (readbackQueue.empty()) {
+      return;
+    }
+    ReadbackJob job = std::move(readbackQueue.front());
+    readbackQueue.pop_front();
+    readbackWriting++;
+    readbackCondition.notify_all();
+    lock.unlock();
+    {
+      TRACE_SCOPE("readback write");
+      std::FILE* file = std::fopen(job.path.c_str(), "wb");
+      if (file) {
+        std::fprintf(file, "P6\n%d %d\n255\n", job.width, job.height);
+        std::vector<unsigned char> row(static_cast<size_t>(job.width) * 3);
+        for (int y = job.height - 1; y >= 0; y--) {
+          const unsigned char* source = job.pixels.data() + static_cast<size_t>(y) * job.width * 4;
+          for (int x = 0; x < job.width; x++) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+          }
+          std::fwrite(row.data(), 1, row.size(), file);
+        }
+        if (std::fclose(file) == 0 && !job.message.empty()) {
+          std::cout << job.message << job.path << std::endl;
+        }
+      } else {
+        std::cerr << "ERROR::IMAGE::CANNOT_OPEN_FILE: " << job.path << std::endl;
+      }
+    }
+    lock.lock();
+    readbackWriting--;
+    readbackCondition.notify_all();
+  }
+}
+
+// Function to map the oldest PBO and queue its pixels for the writer thread
+void completeOldestReadback() {
+  ReadbackSlot& slot = readbackSlots[readbackOldest];
+  if (slot.fence) {
+    GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);  // 1 s
+    while (result == GL_TIMEOUT_EXPIRED) {
+      result = glClientWaitSync(slot.fence, 0, 1000000000);
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+  }
+  ReadbackJob job;
+  job.width = slot.width;
+  job.height = slot.height;
+  job.path = slot.path;
+  job.message = slot.message;
+  size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+  job.pixels.resize(size);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (mapped) {
+    std::memcpy(job.pixels.data(), mapped, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  readbackOldest = (readbackOldest + 1) % READBACK_RING_SIZE;
+  readbackCount--;
+  if (!mapped) {
+    std::cerr << "ERROR::READBACK::MAP_FAILED" << std::endl;
+    return;
+  }
+  std::unique_lock<std::mutex> lock(readbackMutex);
+  if (!readbackThread.joinable()) {
+    readbackStopping = false;
+    readbackThread = std::thread(readbackWriterLoop);
+  }
+  if (readbackQueue.size() >= READBACK_MAX_QUEUED) {
+    // The writer is behind (slow disk): wait rather than drop a frame
+    TRACE_SCOPE("readback queue full");
+    readbackCondition.wait(lock, [] { return readbackQueue.size() < READBACK_MAX_QUEUED; });
+  }
+  readbackQueue.push_back(std::move(job));
+  readbackCondition.notify_all();
+}
+
+// Function to read the current framebuffer into the next PBO (returns immediately);
+// the writer thread prints message and the path once the file is on disk
+void requestReadback(int width, int height, const std::string& path, const std::string& message = "") {
+  TRACE_SCOPE("readback request");
+  // Only waits if the readback from READBACK_RING_SIZE requests ago is still running
+  if (readbackCount == READBACK_RING_SIZE) {
+    completeOldestReadback();
+  }
+  ReadbackSlot& slot = readbackSlots[(readbackOldest + readbackCount) % READBACK_RING_SIZE];
+  size_t size = static_cast<size_t>(width) * height * 4;
+  if (slot.pbo == 0) {
+    glGenBuffers(1, &slot.pbo);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  if (slot.capacity < size) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot.capacity = size;
+  }
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.width = width;
+  slot.height = height;
+  slot.path = path;
+  slot.message = message;
+  readbackCount++;
+}
+
+// Function to hand finished readbacks to the writer; call once per frame.
+// With wait = true every outstanding readback is completed.
+void pollReadbacks(bool wait = false) {
+  while (readbackCount > 0) {
+    GLsync fence = readbackSlots[readbackOldest].fence;
+    if (!wait && fence && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+      return;
+    }
+    completeOldestReadback();
+  }
+}
+
+// Function to finish all readbacks, wait for the files and free the PBOs
+void finishReadbacks() {
+  pollReadbacks(true);
+  {
+    std::unique_lock<std::mutex> lock(readbackMutex);
+    readbackCondition.wait(lock, [] { return readbackQueue.empty() && readbackWriting == 0; });
+    readbackStopping = true;
+    readbackCondition.notify_all();
+  }
+  if (readbackThread.joinable()) {
+    readbackThread.join();
+  }
+  for (int i = 0; i < READBACK_RING_SIZE; i++) {
+    if (readbackSlots[i].pbo != 0) {
+      glDeleteBuffers(1, &readbackSlots[i].pbo);
+      readbackSlots[i].pbo = 0;
+    }
+  }
+}
+
+#endif  // READBACK_H
@@ -1,7 +1,7 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
-#include "shader_manager.h"
+#include "readback.h"
 
 // Forward declarations of helper functions
 void updateAttributeLocations(
@@ -26,59 +26,17 @@ int renderer() {
   //----------------------------------------------------------------------
   // Initialize random seed
   srand(static_cast<unsigned int>(time(nullptr)));
-  // Initialize SDL
-  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
-    std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
-    return 1;
-  }
-  // Set OpenGL attributes - Request core profile for better compatibility with ES
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,
-                      3.3);  // At least OpenGL 3.3 for ES 3.0 compatibility
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-  // Create window with resizable flag
-  SDL_Window* window = SDL_CreateWindow(
-      "GLSL Shader Demo", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH,
-      WINDOW_HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
-  // Check if window was created successfully
-  if (!window) {
-    std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-    SDL_Quit();
-    return 1;
-  }
-  // Create OpenGL context
-  SDL_GLContext glContext = SDL_GL_CreateContext(window);
-  if (!glContext) {
-    std::cerr << "OpenGL context could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-
-    // Try fallback to compatibility profile if core profile fails
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
-    glContext = SDL_GL_CreateContext(window);
-    // Check if fallback context was created successfully
-    if (!glContext) {
-      std::cerr << "Fallback OpenGL context could not be created! SDL_Error: " << SDL_GetError()
-                << std::endl;
-      SDL_DestroyWindow(window);
-      SDL_Quit();
-      return 1;
-    }
-    std::cout << "Using compatibility profile as fallback" << std::endl;
-  }
-  // Initialize GLEW
-  glewExperimental = GL_TRUE;
-  GLenum glewError = glewInit();
-  if (glewError != GLEW_OK) {
-    std::cerr << "GLEW could not be initialized! Error: " << glewGetErrorString(glewError)
-              << std::endl;
-    SDL_GL_DeleteContext(glContext);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+  // Create the window, or an offscreen context rendering into an FBO
+  if (!initBackend("GLSL Shader Demo")) {
+    shutdownBackend();
     return 1;
   }
+  bool headless = backendIsHeadless();
   // Print OpenGL version
   std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
   std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
+  // GPU timing of the quad draw for the trace
+  initGpuTimer();
   //----------------------------------------------------------------------
   // Resource Loading
   //----------------------------------------------------------------------
@@ -93,9 +51,7 @@ int renderer() {
   // Load initial shader program
   GLuint shaderProgram = loadShaders(currentVertexPath, currentFragmentPath);
   if (shaderProgram == 0) {
-    SDL_GL_DeleteContext(glContext);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    shutdownBackend();
     return 1;
   }
   //----------------------------------------------------------------------
@@ -186,10 +142,15 @@ int renderer() {
   SDL_Event e;
   // For timing
   uint32_t startTime = SDL_GetTicks();
+  int frameIndex = 0;
+  bool screenshotRequested = false;
   // Main loop
   while (!quit) {
+    TRACE_SCOPE("frame");
     // Handle events
-    while (SDL_PollEvent(&e) != 0) {
+    uint64_t eventPumpStart = tracePath.empty() ? 0 : traceNowNs();
+    // Offscreen backends have no window and no input
+    while (!headless && SDL_PollEvent(&e) != 0) {
       if (e.type == SDL_QUIT) {
         quit = true;
       } else if (e.type == SDL_KEYDOWN) {
@@ -251,6 +212,14 @@ int renderer() {
             // Toggle auto-reload
             toggleAutoReload();
             break;
+          case SDLK_F2:
+            // Write the trace recorded so far
+            writeTrace();
+            break;
+          case SDLK_F6:
+            // Save a screenshot (read back asynchronously)
+            screenshotRequested = true;
+            break;
         }
       }
       // Handle mouse clicks
@@ -277,6 +246,9 @@ int renderer() {
         handleResize(e.window.data1, e.window.data2);
       }
     }
+    if (eventPumpStart != 0) {
+      traceRecord("event pump", eventPumpStart, traceNowNs() - eventPumpStart);
+    }
     // Auto-reload shader if enabled
     if (autoReloadEnabled) {
       Uint32 currentTime = SDL_GetTicks();
@@ -295,11 +267,12 @@ int renderer() {
     }
     // Generate random value for shader
     float randomValue = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-    // Calculate elapsed time in milliseconds
-    float currentTime = SDL_GetTicks() - startTime;
+    // Calculate elapsed time in milliseconds (offscreen: fixed 60 Hz steps)
+    float currentTime = headless ? frameIndex * 1000.0f / 60.0f : SDL_GetTicks() - startTime;
     // Clear the screen
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+    uint64_t uniformSetupStart = tracePath.empty() ? 0 : traceNowNs();
     // Use the shader program
     glUseProgram(shaderProgram);
     // Activate texture unit 0 and bind the background texture
@@ -375,29 +348,66 @@ int renderer() {
       // Pass the circle data to the shader
       glUniform3fv(circlesLocation, numCircles, circleData.data());
     }
+    if (uniformSetupStart != 0) {
+      traceRecord("uniform setup", uniformSetupStart, traceNowNs() - uniformSetupStart);
+    }
     // Draw the quad
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    {
+      TRACE_SCOPE("draw submission");
+      beginGpuTimer();
+      glBindVertexArray(VAO);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+      glBindVertexArray(0);
+      endGpuTimer();
+    }
+    // Screenshots and frame dumps go through the PBO ring, the writer thread saves them
+    if (screenshotRequested) {
+      requestReadback(WINDOW_WIDTH, WINDOW_HEIGHT, "screenshot_" + std::to_string(frameIndex) + ".ppm", "Screenshot: ");
+      screenshotRequested = false;
+    }
+    if (!dumpFramesPrefix.empty()) {
+      char dumpPath[32];
+      std::snprintf(dumpPath, sizeof(dumpPath), "_%06d.ppm", frameIndex);
+      requestReadback(WINDOW_WIDTH, WINDOW_HEIGHT, dumpFramesPrefix + dumpPath);
+    }
+    // Offscreen runs end after headlessFrames frames, saving the last one
+    frameIndex++;
+    if (headless && frameIndex >= headlessFrames) {
+      if (!outputPath.empty()) {
+        requestReadback(WINDOW_WIDTH, WINDOW_HEIGHT, outputPath, "Frame written to: ");
+      }
+      quit = true;
+    }
     // Swap buffers
-    SDL_GL_SwapWindow(window);
+    presentBackend();
+    // Hand finished readbacks from earlier frames to the writer thread
+    pollReadbacks();
+    // Collect GPU timings from earlier frames
+    resolveGpuTimer();
     // Add a small delay to reduce CPU usage
-    SDL_Delay(delay);
+    if (!headless) {
+      SDL_Delay(delay);
+    }
   }
   //----------------------------------------------------------------------
   // Cleanup
   //----------------------------------------------------------------------
+  // Write out the remaining screenshots / frame dumps
+  finishReadbacks();
+  // Write the trace recorded during this run
+  if (!tracePath.empty()) {
+    writeTrace();
+  }
+  releaseGpuTimer();
   glDeleteVertexArrays(1, &VAO);
   glDeleteBuffers(1, &VBO);
   glDeleteBuffers(1, &EBO);
   glDeleteProgram(shaderProgram);
-  SDL_GL_DeleteContext(glContext);
-  SDL_DestroyWindow(window);
-  SDL_Quit();
   // Free the background texture if it was loaded
   if (backgroundTexture != 0) {
     glDeleteTextures(1, &backgroundTexture);
   }
+  shutdownBackend();
   std::cout << "Exiting program." << std::endl;
   return 0;
 }
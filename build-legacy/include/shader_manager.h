@@ -31,6 +31,8 @@ GLuint loadShaders(const std::string& vertexPath, const std::string& fragmentPat
 
 // Function to reload the current shader
 GLuint reloadCurrentShader(GLuint currentProgram) {
+    TRACE_SCOPE("reload");
+
     // Delete the current program
     if (currentProgram != 0) {
         glDeleteProgram(currentProgram);
@@ -53,6 +55,8 @@ GLuint reloadCurrentShader(GLuint currentProgram) {
 
 // Function to load a texture from file
 GLuint loadTexture(const std::string& path) {
+    TRACE_SCOPE("texture load");
+
     // Initialize SDL_image
     if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
         std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
@@ -0,0 +1,207 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "includes.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+
+// Chrome trace / Perfetto recorder for the legacy renderer phases.
+// Each thread records into its own ring buffer without locking; the buffers are
+// written out as Chrome trace JSON on demand (F2) and at exit.
+
+// Chrome trace output path (empty = tracing disabled), set from the command line
+std::string tracePath = "";
+
+// Events kept per thread - older events are overwritten once the ring wraps
+const uint32_t TRACE_BUFFER_CAPACITY = 1 << 16;
+
+// Track id used for GPU timer results
+const uint32_t TRACE_GPU_TRACK = 1000;
+
+// One complete ("ph":"X") event - names must be string literals
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t track;
+};
+
+// One ring slot. sequence is odd while the owner writes the event and 2 * (index + 1)
+// once event number index is complete, so a snapshot can skip slots it raced with
+struct TraceSlot {
+    std::atomic<uint64_t> sequence{0};
+    TraceEvent event;
+};
+
+// Per-thread ring buffer, only written by its owning thread
+struct TraceThreadBuffer {
+    TraceSlot slots[TRACE_BUFFER_CAPACITY];
+    std::atomic<uint64_t> writeIndex{0};
+    uint32_t track = 0;
+    TraceThreadBuffer* next = nullptr;
+};
+
+std::atomic<TraceThreadBuffer*> traceBufferList{nullptr};
+std::atomic<uint32_t> traceNextTrack{1};
+
+// Current time on the trace clock in nanoseconds
+uint64_t traceNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Record a finished event on the calling thread's buffer
+void traceRecord(const char* name, uint64_t startNs, uint64_t durationNs, uint32_t track = 0) {
+    if (tracePath.empty()) {
+        return;
+    }
+    thread_local TraceThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new TraceThreadBuffer();
+        buffer->track = traceNextTrack.fetch_add(1);
+        buffer->next = traceBufferList.load(std::memory_order_relaxed);
+        while (!traceBufferList.compare_exchange_weak(buffer->next, buffer,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+        }
+    }
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    TraceSlot& slot = buffer->slots[index % TRACE_BUFFER_CAPACITY];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.name = name;
+    slot.event.startNs = startNs;
+    slot.event.durationNs = durationNs;
+    slot.event.track = track ? track : buffer->track;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+// Scoped CPU zone - records its lifetime as one event
+struct TraceScope {
+    const char* name;
+    uint64_t startNs;
+    TraceScope(const char* name) : name(name), startNs(tracePath.empty() ? 0 : traceNowNs()) {}
+    ~TraceScope() {
+        if (startNs != 0) {
+            traceRecord(name, startNs, traceNowNs() - startNs);
+        }
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+// GPU timestamp queries around the quad draw, read back a few frames later
+const int GPU_TIMER_RING_SIZE = 4;
+GLuint gpuTimerQueries[GPU_TIMER_RING_SIZE][2];
+bool gpuTimerPending[GPU_TIMER_RING_SIZE] = {false};
+int gpuTimerSlot = 0;
+bool gpuTimerSupported = false;
+int64_t gpuToTraceOffsetNs = 0;
+
+// Function to create the GPU timer queries (needs a current GL context)
+void initGpuTimer() {
+    gpuTimerSupported = !tracePath.empty() && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+    if (!gpuTimerSupported) {
+        return;
+    }
+    glGenQueries(GPU_TIMER_RING_SIZE * 2, &gpuTimerQueries[0][0]);
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuToTraceOffsetNs = static_cast<int64_t>(traceNowNs()) - static_cast<int64_t>(gpuNow);
+}
+
+void beginGpuTimer() {
+    if (gpuTimerSupported && !gpuTimerPending[gpuTimerSlot]) {
+        glQueryCounter(gpuTimerQueries[gpuTimerSlot][0], GL_TIMESTAMP);
+    }
+}
+
+void endGpuTimer() {
+    if (gpuTimerSupported && !gpuTimerPending[gpuTimerSlot]) {
+        glQueryCounter(gpuTimerQueries[gpuTimerSlot][1], GL_TIMESTAMP);
+        gpuTimerPending[gpuTimerSlot] = true;
+        gpuTimerSlot = (gpuTimerSlot + 1) % GPU_TIMER_RING_SIZE;
+    }
+}
+
+// Function to move finished GPU timings into the trace, oldest first
+void resolveGpuTimer() {
+    for (int i = 0; gpuTimerSupported && i < GPU_TIMER_RING_SIZE; i++) {
+        int slot = (gpuTimerSlot + i) % GPU_TIMER_RING_SIZE;
+        if (!gpuTimerPending[slot]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(gpuTimerQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 startTicks = 0, endTicks = 0;
+        glGetQueryObjectui64v(gpuTimerQueries[slot][0], GL_QUERY_RESULT, &startTicks);
+        glGetQueryObjectui64v(gpuTimerQueries[slot][1], GL_QUERY_RESULT, &endTicks);
+        gpuTimerPending[slot] = false;
+        traceRecord("draw", static_cast<uint64_t>(static_cast<int64_t>(startTicks) + gpuToTraceOffsetNs),
+                    endTicks > startTicks ? endTicks - startTicks : 0, TRACE_GPU_TRACK);
+    }
+}
+
+// Function to delete the GPU timer queries (the context must still be current)
+void releaseGpuTimer() {
+    if (gpuTimerSupported) {
+        glDeleteQueries(GPU_TIMER_RING_SIZE * 2, &gpuTimerQueries[0][0]);
+        gpuTimerSupported = false;
+    }
+}
+
+// Function to write all recorded events as Chrome trace JSON
+bool writeTrace() {
+    if (tracePath.empty()) {
+        std::cout << "Tracing is disabled, start with --trace <file>" << std::endl;
+        return false;
+    }
+    std::vector<TraceEvent> events;
+    for (TraceThreadBuffer* buffer = traceBufferList.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_BUFFER_CAPACITY ? end - TRACE_BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const TraceSlot& slot = buffer->slots[i % TRACE_BUFFER_CAPACITY];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence == 2 * i + 2 && slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                events.push_back(event);
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.startNs < b.startNs;
+    });
+    uint64_t originNs = events.empty() ? 0 : events.front().startNs;
+
+    std::FILE* file = std::fopen(tracePath.c_str(), "w");
+    if (!file) {
+        std::cerr << "ERROR::TRACE::CANNOT_OPEN_FILE: " << tracePath << std::endl;
+        return false;
+    }
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+                 TRACE_GPU_TRACK);
+    for (const TraceEvent& event : events) {
+        // GPU events can start slightly before the first CPU event after calibration
+        double ts = (static_cast<int64_t>(event.startNs) - static_cast<int64_t>(originNs)) / 1000.0;
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     event.name, event.track, ts, event.durationNs / 1000.0);
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    std::cout << "Trace written to: " << tracePath << " (" << events.size() << " events)" << std::endl;
+    return true;
+}
+
+#endif // TRACE_H
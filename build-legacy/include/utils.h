@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include "includes.h"
+#include "trace.h"
 
 // Add these includes at the top of shader_utils.h
 #ifdef _WIN32
@@ -109,6 +110,8 @@ GLuint createShaderFromFile(const std::string& filePath, GLenum shaderType) {
 
 // Function to create a shader program from vertex and fragment shader files
 GLuint createShaderProgram(const std::string& vertexPath, const std::string& fragmentPath) {
+    TRACE_SCOPE("shader compile");
+
     // Create and compile shaders
     GLuint vertexShader = createShaderFromFile(vertexPath, GL_VERTEX_SHADER);
     GLuint fragmentShader = createShaderFromFile(fragmentPath, GL_FRAGMENT_SHADER);
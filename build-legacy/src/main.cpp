@@ -2,6 +2,31 @@
 
 
 int main(int argc, char* argv[]) {
+    // --trace <file> records the frame phases as a Chrome trace
+    // --backend <window|egl|osmesa> (--headless = egl), --size WxH, --frames <n>, --output <file.ppm>
+    // --dump-frames <prefix> writes every frame as <prefix>_NNNNNN.ppm (F6 saves one screenshot)
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backendName = argv[++i];
+        } else if (arg == "--headless") {
+            backendName = "egl";
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &WINDOW_WIDTH, &WINDOW_HEIGHT) != 2 ||
+                WINDOW_WIDTH < 1 || WINDOW_HEIGHT < 1) {
+                std::cerr << "--size expects WIDTHxHEIGHT, e.g. 1920x1080" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--frames" && i + 1 < argc) {
+            headlessFrames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--dump-frames" && i + 1 < argc) {
+            dumpFramesPrefix = argv[++i];
+        }
+    }
     renderer(); // Call the drawer function
     return 0;
 }
\ No newline at end of file
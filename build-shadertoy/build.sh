@@ -3,8 +3,30 @@ rm -f shadertoy_renderer.exe
 sleep 0.5
 
 cd src
-g++ -o shadertoy_renderer main.cpp shader_manager.cpp shadertoy_utils.cpp -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+SOURCES="shader_manager.cpp shadertoy_utils.cpp options.cpp trace.cpp gpu_timer.cpp frame_stats.cpp hud.cpp latency.cpp render_target.cpp watchdog.cpp frame_pacer.cpp backend.cpp image_io.cpp file_io.cpp async_readback.cpp video_export.cpp tiled_render.cpp batch_render.cpp thumbnail_cache.cpp shared_frames.cpp dynamic_resolution.cpp quality_governor.cpp accumulation.cpp interleaved_render.cpp foveated_render.cpp time_sliced_render.cpp depth_prepass.cpp sdf_bake.cpp loop_cache.cpp"
 
-sleep 1
+if [ "$OS" = "Windows_NT" ]; then
+    g++ -o shadertoy_renderer main.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+    g++ -o shader_bench shader_bench.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+    g++ -o shader_golden shader_golden.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+    g++ -o shader_jobs shader_jobs.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+    g++ -o shader_thumbs shader_thumbs.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
+    g++ -o shader_sdfbake shader_sdfbake.cpp $SOURCES -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
 
-./shadertoy_renderer.exe
\ No newline at end of file
+    sleep 1
+
+    ./shadertoy_renderer.exe
+else
+    # Linux / render farm build with the headless EGL backend (--backend egl)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -o shadertoy_renderer main.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+    # Benchmark suite: ./shader_bench --output results.json (software GL: LIBGL_ALWAYS_SOFTWARE=1)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -O2 -o shader_bench shader_bench.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+    # Golden-image regression check: ./shader_golden (./shader_golden --update stores new references)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -O2 -o shader_golden shader_golden.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+    # Offline job scheduler: ./shader_jobs jobs.txt (resumes from jobs.txt.done)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -O2 -o shader_jobs shader_jobs.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+    # Library previews: ./shader_thumbs (only changed shaders are rendered into ../thumbnails.cache)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -O2 -o shader_thumbs shader_thumbs.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+    # Distance volumes of static SDF scenes: ./shader_sdfbake (cached in ../shaderN.sdf.cache, used by --baked-sdf)
+    g++ -std=c++14 -DSHADERTOY_WITH_EGL -O2 -o shader_sdfbake shader_sdfbake.cpp $SOURCES -lSDL2 -lGLEW -lGL -lEGL -lrt -pthread
+fi
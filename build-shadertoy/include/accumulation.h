@@ -0,0 +1,69 @@
+#ifndef ACCUMULATION_H
+#define ACCUMULATION_H
+
+#include "includes.h"
+#include "render_target.h"
+
+// Everything that changes the image of a still frame; any change restarts the accumulation
+struct AccumulationInputs {
+    int shader = -1;
+    GLuint program = 0;
+    int width = 0;
+    int height = 0;
+    float time = 0.0f;
+    int mouseX = 0;
+    int mouseY = 0;
+    bool mouseDown = false;
+
+    bool operator==(const AccumulationInputs& other) const {
+        return shader == other.shader && program == other.program && width == other.width &&
+               height == other.height && time == other.time && mouseX == other.mouseX &&
+               mouseY == other.mouseY && mouseDown == other.mouseDown;
+    }
+};
+
+// Progressive rendering of still views: every frame draws one jittered sample per
+// pixel, blended into a float history with weight 1 / (n + 1), so the history is the
+// running mean of all samples. The first sample is centred, like a normal frame, and
+// later ones follow a Halton (2, 3) sequence over the pixel. Once maxSamples are in,
+// the history is presented without drawing at all.
+class ProgressiveAccumulator {
+public:
+    ProgressiveAccumulator();
+
+    void setEnabled(bool value);
+    bool isEnabled() const { return enabled; }
+    void setMaxSamples(int value) { maxSamples = value > 0 ? value : 1; }
+    int getMaxSamples() const { return maxSamples; }
+
+    // Start a frame: restarts on changed inputs, binds the history and sets up blending.
+    // Returns false if nothing needs drawing (converged) or the history can't be created.
+    bool begin(const AccumulationInputs& inputs);
+
+    // Pixel offset of this frame's sample, for the wrapper's iJitter
+    float getJitterX() const { return jitterX; }
+    float getJitterY() const { return jitterY; }
+
+    // Finish the frame's draw (blending off) and count the sample
+    void end();
+
+    // Stretch the history onto the screen
+    void blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer) const;
+
+    int getSampleCount() const { return sampleCount; }
+    bool hasHistory() const { return history.isValid() && sampleCount > 0; }
+
+    // Delete the history (the owning context must be current)
+    void release();
+
+private:
+    bool enabled;
+    int maxSamples;
+    int sampleCount;
+    float jitterX;
+    float jitterY;
+    AccumulationInputs lastInputs;
+    RenderTarget history;
+};
+
+#endif // ACCUMULATION_H
@@ -0,0 +1,87 @@
+#ifndef ASYNC_READBACK_H
+#define ASYNC_READBACK_H
+
+#include "includes.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// PBOs in the ring: a readback is mapped up to this many frames after it was issued
+const int READBACK_RING_SIZE = 3;
+
+// A finished readback: tightly packed RGBA, top row first
+struct ReadbackFrame {
+    std::vector<unsigned char> pixels;
+    int width;
+    int height;
+    uint64_t frameIndex;
+    std::string tag;    // Caller's label, e.g. the output file
+};
+
+// Asynchronous framebuffer readback through a ring of pixel buffer objects.
+// request() issues glReadPixels into a PBO and fences it, which returns at once;
+// poll() maps the PBOs whose fence has signalled and hands the copy to a consumer
+// thread, which flips the rows and runs the callback (e.g. writes the file).
+// The render thread only ever waits when the whole ring is still in flight.
+class AsyncReadback {
+public:
+    typedef std::function<void(ReadbackFrame&)> Consumer;
+
+    AsyncReadback();
+    ~AsyncReadback();
+
+    // Start the consumer thread; frames beyond maxQueued wait for it (backpressure)
+    void start(Consumer frameConsumer, size_t maxQueued = 8);
+
+    // Queue a readback of the framebuffer's color attachment (GL thread)
+    bool request(GLuint framebuffer, int width, int height, uint64_t frameIndex, const std::string& tag);
+
+    // Hand over finished readbacks; call once per frame on the GL thread.
+    // With wait = true every outstanding readback is completed first.
+    void poll(bool wait = false);
+
+    // Complete everything, wait until the consumer is idle and stop it
+    void finish();
+
+    // Readbacks issued but not yet consumed
+    int getPendingCount() const;
+
+    // Time the render thread spent blocked on a full ring or queue, in ms
+    float getStallMs() const { return stallMs; }
+
+private:
+    struct Slot {
+        GLuint pbo;
+        GLsync fence;
+        size_t capacity;
+        int width;
+        int height;
+        uint64_t frameIndex;
+        std::string tag;
+    };
+
+    Slot slots[READBACK_RING_SIZE];
+    int oldest;
+    int count;
+    bool supported;
+    float stallMs;
+
+    Consumer consumer;
+    size_t maxQueued;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<ReadbackFrame> queue;
+    int busy;
+    bool stopping;
+
+    // Wait for the oldest slot's fence (poll(false) only calls it once that has signalled)
+    // and hand its pixels to the consumer
+    void completeOldest();
+    void enqueue(ReadbackFrame&& frame);
+    void consumerLoop();
+};
+
+#endif // ASYNC_READBACK_H
@@ -0,0 +1,51 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include "includes.h"
+#include "render_target.h"
+#include <memory>
+
+// Where the GL context comes from and where finished frames go
+enum BackendType {
+    BACKEND_WINDOW,   // SDL window with a double-buffered context
+    BACKEND_EGL,      // Headless EGL context without a surface (EGL_MESA_platform_surfaceless)
+    BACKEND_OSMESA    // Headless Mesa software context (GL/osmesa.h)
+};
+
+// Parse "window", "egl" or "osmesa"
+bool parseBackendType(const std::string& name, BackendType& type);
+const char* getBackendName(BackendType type);
+
+// Owns the GL context and the surface frames are presented to. The renderer binds
+// getFramebuffer() as its "screen", so window and offscreen rendering share one path.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+
+    // Create the context (and window) and make it current; also initializes GLEW
+    virtual bool init(const char* title, int width, int height) = 0;
+
+    // Make the context current on the calling thread / release it
+    virtual bool makeCurrent() = 0;
+    virtual void releaseCurrent() = 0;
+
+    // Framebuffer that stands for the screen (0 for a window)
+    virtual GLuint getFramebuffer() const = 0;
+
+    // Follow a new output size (offscreen backends reallocate their target)
+    virtual void resize(int width, int height) = 0;
+
+    // Finish the frame: swap the window or flush the offscreen context
+    virtual void present() = 0;
+
+    virtual bool isHeadless() const = 0;
+    virtual BackendType getType() const = 0;
+};
+
+// Create a backend of the given type (not initialized yet)
+std::unique_ptr<RenderBackend> createRenderBackend(BackendType type);
+
+// Read the backend's screen back as tightly packed RGBA, top row first
+bool readFramebufferRGBA(GLuint framebuffer, int width, int height, std::vector<unsigned char>& pixels);
+
+#endif // BACKEND_H
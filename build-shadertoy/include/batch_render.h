@@ -0,0 +1,71 @@
+#ifndef BATCH_RENDER_H
+#define BATCH_RENDER_H
+
+#include "includes.h"
+#include "backend.h"
+#include "video_export.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+// Frames per work item; small enough to balance, large enough to keep queue traffic low
+const int BATCH_CHUNK_FRAMES = 4;
+
+// A half-open range of frames [begin, end)
+struct FrameRange {
+    int begin;
+    int end;
+};
+
+// Shared queue of frame ranges, handed out in frame order. The writer needs the frames
+// in order, so whichever worker is free takes the lowest range left: a slow worker
+// only holds up the range it is drawing, and the others carry on past it.
+class FrameRangeQueue {
+public:
+    FrameRangeQueue(int frameCount, int chunkFrames);
+
+    // Next range; false when all have been handed out
+    bool pop(FrameRange& range);
+
+private:
+    std::mutex mutex;
+    int nextFrame;
+    int frameCount;
+    int chunkFrames;
+};
+
+// Puts frames finished out of order back in order. push() blocks while the frame is
+// more than `window` frames ahead of the next one to be written, which bounds memory.
+class FrameReorderBuffer {
+public:
+    FrameReorderBuffer(int frameCount, int window);
+
+    void push(int frameIndex, std::vector<unsigned char>&& pixels);
+
+    // Wait for the next frame in order; false after the last frame or on abort()
+    bool popNext(std::vector<unsigned char>& pixels, int& frameIndex);
+
+    // Wake everybody up and make them give up (a worker failed)
+    void abort();
+    bool isAborted() const;
+
+private:
+    int frameCount;
+    int window;
+    int nextIndex;
+    bool aborted;
+    std::map<int, std::vector<unsigned char>> frames;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+};
+
+// Export like exportVideo, but on `workers` independent offscreen contexts, each on its
+// own thread. The first context compiles the shader and the others restore its program
+// binary (or compile themselves if the driver has none). With scalingReport the job is
+// first timed with 1, 2, 4 ... workers and the speedup / efficiency versus one context
+// is printed; only the final run with all workers writes the output.
+bool exportVideoParallel(const std::string& fragmentSource, BackendType backend,
+                         const VideoExportSettings& settings, int workers, bool scalingReport);
+
+#endif // BATCH_RENDER_H
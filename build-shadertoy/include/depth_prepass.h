@@ -0,0 +1,44 @@
+#ifndef DEPTH_PREPASS_H
+#define DEPTH_PREPASS_H
+
+#include "includes.h"
+#include "render_target.h"
+#include "shader_manager.h"
+
+// Default block edge in pixels of the prepass
+const int DEFAULT_PREPASS_BLOCK = 8;
+
+// Texture unit of the prepass depth during the full pass (ShaderToy code has no samplers)
+const int PREPASS_TEXTURE_UNIT = 3;
+
+// Whether ShaderToy code uses the depth prepass hook (shadertoyRayStart)
+bool shaderUsesDepthPrepass(const std::string& shaderToyCode);
+
+// Two-pass ray marching for shaders that opt into the hook: the prepass marches one
+// cone per block of pixels, through the block's centre and wide enough to contain
+// every ray of the block, and records how far it got without touching the scene.
+// The full-resolution pass then starts each ray there instead of at the camera.
+class DepthPrepass {
+public:
+    DepthPrepass();
+
+    void setBlockSize(int value);
+    int getBlockSize() const { return blockSize; }
+
+    // Draw the prepass of the program in use (uniforms set for a width x height frame),
+    // then restore the caller's framebuffer and viewport and set the program up for the
+    // full pass. Returns false (program left as is) if the target can't be created.
+    bool begin(ShaderManager& shader, GLuint quadVAO, int width, int height);
+
+    // Back to plain marching from the camera
+    void end(ShaderManager& shader);
+
+    // Delete the target (the owning context must be current)
+    void release() { depth.release(); }
+
+private:
+    int blockSize;
+    RenderTarget depth;
+};
+
+#endif // DEPTH_PREPASS_H
@@ -0,0 +1,47 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "includes.h"
+
+// Dynamic resolution tuning
+struct DynamicResolutionConfig {
+    float targetMs = 1000.0f / 60.0f;   // Frame cost to aim for
+    float minScale = 0.25f;             // Render scale range (per axis)
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;            // Scales are multiples of this, so the target is rarely reallocated
+    float headroom = 0.9f;              // Aim for targetMs * headroom
+    float raiseFraction = 0.8f;         // Only step up once the cost is below the aim * this
+};
+
+// Picks the render scale of each frame from the measured frame cost. Shading cost
+// grows with the pixel count, i.e. scale squared, so the scale that hits the target
+// is predicted as scale * sqrt(target / cost). Drops happen at once, raises one step
+// at a time with hysteresis, and every change waits for the timings to settle.
+class DynamicResolution {
+public:
+    DynamicResolution();
+
+    void setConfig(const DynamicResolutionConfig& value);
+    const DynamicResolutionConfig& getConfig() const { return config; }
+    void setEnabled(bool value);
+    bool isEnabled() const { return enabled; }
+
+    // Scale of the next frame (1 when disabled)
+    float getScale() const { return enabled ? scale : 1.0f; }
+
+    // Draw cost of a frame rendered at getScale(): GPU time, or the CPU time up to present
+    // without timer queries (never the vsync or present wait)
+    void reportFrame(float costMs);
+
+    // Forget the smoothed cost (shader switch, resize); the scale is kept
+    void reset();
+
+private:
+    DynamicResolutionConfig config;
+    bool enabled;
+    float scale;
+    float smoothedMs;
+    int settleFrames;
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -0,0 +1,29 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include "includes.h"
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+// One value in host byte order (the cache files are little-endian, as written by the host)
+template <typename T>
+bool readValue(std::FILE* file, T& value) {
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+void writeValue(std::FILE* file, const T& value) {
+    std::fwrite(&value, sizeof(T), 1, file);
+}
+
+// 64-bit FNV-1a; the caches key their entries by the hash of the source they came from
+uint64_t hashSource(const std::string& text);
+
+// Write a file through "<filePath>.tmp", which replaces filePath only once write has
+// filled it without an error, so an interrupted save leaves the old file in place.
+// Errors are reported as ERROR::<module>::... ; mode is "wb" or "w".
+bool saveFileAtomically(const std::string& filePath, const char* module, const char* mode,
+                        const std::function<void(std::FILE*)>& write);
+
+#endif // FILE_IO_H
@@ -0,0 +1,55 @@
+#ifndef FOVEATED_RENDER_H
+#define FOVEATED_RENDER_H
+
+#include "includes.h"
+#include "render_target.h"
+#include "shader_manager.h"
+
+// Foveation tuning, in window pixels
+struct FoveationConfig {
+    float radius = 200.0f;      // Full resolution inside this distance from the cursor
+    float falloff = 100.0f;     // Width of each blend ring
+};
+
+// Renders the frame in three layers around a focus point: the whole frame at a
+// quarter of the resolution, a box around the focus at half, and a smaller box at
+// full resolution. The boxes are drawn as tiles of the full image (iTile), so shaders
+// see the usual iResolution. A composite pass blends the layers with smoothstep rings:
+// full resolution up to radius, half resolution up to radius + falloff, then the
+// quarter-resolution periphery from radius + 2 * falloff on.
+class FoveatedRenderer {
+public:
+    FoveatedRenderer();
+
+    // Compile the composite pass - needs a current GL context
+    bool init();
+
+    void setConfig(const FoveationConfig& value);
+    const FoveationConfig& getConfig() const { return config; }
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // Draw the active program (uniforms already set) around focusX, focusY (pixels from
+    // the top-left, like the mouse) and composite the result into the screen framebuffer
+    bool render(ShaderManager& shader, GLuint quadVAO, int width, int height, int focusX, int focusY,
+                GLuint screenFramebuffer);
+
+    // Share of the fragments of a full-resolution frame saved by the last frame / overall
+    float getLastSavedFraction() const { return lastSavedFraction; }
+    uint64_t getShadedFragments() const { return shadedFragments; }
+    uint64_t getFullFragments() const { return fullFragments; }
+
+    // Delete the targets (the owning context must be current)
+    void release();
+
+private:
+    bool enabled;
+    FoveationConfig config;
+    RenderTarget layers[3];
+    ShaderManager composite;
+    float lastSavedFraction;
+    uint64_t shadedFragments;
+    uint64_t fullFragments;
+};
+
+#endif // FOVEATED_RENDER_H
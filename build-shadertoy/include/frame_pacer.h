@@ -0,0 +1,35 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include "includes.h"
+
+// Upper bound for the configurable frames in flight
+const int MAX_FRAMES_IN_FLIGHT_LIMIT = 3;
+
+// Limits how many frames the driver may queue ahead of the GPU.
+// A fence is inserted after every swap; at the top of the loop we wait on the
+// oldest fence until fewer than maxFramesInFlight frames are outstanding.
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    // Allowed frames in flight, clamped to 1..MAX_FRAMES_IN_FLIGHT_LIMIT
+    void setMaxFramesInFlight(int value);
+    int getMaxFramesInFlight() const { return maxFramesInFlight; }
+
+    // Block until another frame may be submitted; returns the time waited in ms
+    float waitForFrameSlot();
+
+    // Fence the frame that was just submitted (call right after the swap)
+    void onFrameSubmitted();
+
+private:
+    GLsync fences[MAX_FRAMES_IN_FLIGHT_LIMIT];
+    int oldest;
+    int count;
+    int maxFramesInFlight;
+    bool supported;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,43 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include "includes.h"
+
+// Number of frames kept for the graph and the percentiles
+const int FRAME_STATS_HISTORY = 240;
+
+// Timings of one frame in milliseconds
+struct FrameSample {
+    float frameMs;  // Full frame interval, including the frame delay
+    float cpuMs;    // Main thread work from event pump to swap
+    float gpuMs;    // Shader draw on the GPU (-1 if unknown)
+    float waitMs;   // Time blocked by the frames-in-flight limit
+};
+
+// Rolling history of frame timings
+class FrameStats {
+public:
+    FrameStats();
+
+    // Add the timings of a finished frame
+    void addFrame(float frameMs, float cpuMs, float gpuMs, float waitMs);
+
+    // Frame time percentile (0-100) over the history
+    float getFrameMsPercentile(float percentile) const;
+
+    // Average frames per second over the history
+    float getAverageFps() const;
+
+    // Sample by age, 0 = most recent frame
+    const FrameSample& getSample(int age) const;
+
+    // Number of valid samples (up to FRAME_STATS_HISTORY)
+    int getCount() const { return count; }
+
+private:
+    FrameSample samples[FRAME_STATS_HISTORY];
+    int next;
+    int count;
+};
+
+#endif // FRAME_STATS_H
@@ -0,0 +1,45 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include "includes.h"
+#include <cstdint>
+
+// Number of frames a query may stay in flight before we stop waiting for it
+const int GPU_TIMER_RING_SIZE = 4;
+
+// GPU timestamp queries for one named zone. Results are read back a few frames
+// later (never stalling the pipeline) and forwarded to the trace as GPU events.
+class GpuTimer {
+public:
+    GpuTimer(const char* name);
+    ~GpuTimer();
+
+    // Create the queries - needs a current GL context
+    bool init();
+
+    // Bracket the GPU work of this frame
+    void begin();
+    void end();
+
+    // Collect finished queries; call once per frame
+    void resolve();
+
+    // Duration of the most recently resolved zone in milliseconds (-1 if none yet)
+    float getLastMs() const { return lastMs; }
+    bool isSupported() const { return supported; }
+
+private:
+    const char* name;
+    bool supported;
+    GLuint queries[GPU_TIMER_RING_SIZE][2];
+    bool pending[GPU_TIMER_RING_SIZE];
+    int writeSlot;
+    bool open;
+    float lastMs;
+    int64_t gpuToTraceOffsetNs;
+    uint64_t lastCalibrationNs;
+
+    void calibrate();
+};
+
+#endif // GPU_TIMER_H
@@ -0,0 +1,49 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "includes.h"
+#include "frame_stats.h"
+#include "shader_manager.h"
+
+// Performance overlay: frame-time graph, FPS/percentiles, shader name, CPU and GPU ms.
+// Everything is batched into one dynamic vertex buffer and drawn with a single
+// draw call, textured from a bitmap font atlas baked at startup.
+class Hud {
+public:
+    Hud();
+    ~Hud();
+
+    // Bake the font atlas and create the GL objects - needs a current GL context
+    bool init();
+
+    // Draw the overlay on top of the current framebuffer
+    void draw(const FrameStats& stats, const std::string& shaderName, int windowWidth, int windowHeight);
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+    void setVisible(bool value) { visible = value; }
+
+private:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        float r, g, b, a;
+    };
+
+    bool visible;
+    ShaderManager shader;
+    GLuint programID;
+    GLuint atlasTexture;
+    GLuint vao;
+    GLuint vbo;
+    GLint screenLoc;
+    size_t vboCapacity;
+    std::vector<Vertex> vertices;
+
+    void addQuad(float x, float y, float w, float h, float u0, float v0, float u1, float v1,
+                 float r, float g, float b, float a);
+    void addRect(float x, float y, float w, float h, float r, float g, float b, float a);
+    void addText(const std::string& text, float x, float y, float r, float g, float b);
+};
+
+#endif // HUD_H
@@ -0,0 +1,39 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+#include "includes.h"
+#include <cstdint>
+#include <cstdio>
+
+// Write tightly packed RGBA pixels (top row first) as a binary PPM; alpha is dropped
+bool writePPM(const std::string& filePath, int width, int height, const std::vector<unsigned char>& pixels);
+
+// Read a binary PPM (P6, maxval 255) into RGBA pixels with alpha 255
+bool readPPM(const std::string& filePath, int& width, int& height, std::vector<unsigned char>& pixels);
+
+// Binary PPM written tile by tile: the header is written up front and each tile's rows
+// are stored at their final offset, so the whole image never has to be in memory
+class PPMTileWriter {
+public:
+    PPMTileWriter();
+    ~PPMTileWriter();
+
+    // Create the file (needs a seekable path, not a pipe)
+    bool open(const std::string& filePath, int imageWidth, int imageHeight);
+
+    // Store RGBA pixels (top row first) whose top-left corner is at x, y from the image's top-left
+    bool writeTile(int x, int y, int tileWidth, int tileHeight, const std::vector<unsigned char>& pixels);
+
+    // Returns false if any write failed
+    bool close();
+
+private:
+    std::FILE* file;
+    int width;
+    int height;
+    uint64_t headerSize;
+    bool failed;
+    std::vector<unsigned char> row;
+};
+
+#endif // IMAGE_IO_H
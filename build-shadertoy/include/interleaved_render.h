@@ -0,0 +1,66 @@
+#ifndef INTERLEAVED_RENDER_H
+#define INTERLEAVED_RENDER_H
+
+#include "includes.h"
+#include "render_target.h"
+#include "shader_manager.h"
+
+// Share of the pixels shaded per frame
+enum InterleaveMode {
+    INTERLEAVE_OFF = 0,
+    INTERLEAVE_CHECKERBOARD,    // Half: alternate pixels of each row, the pattern flips every frame
+    INTERLEAVE_QUARTER,         // One pixel of every 2x2 block, cycling through the four in 4 frames
+    INTERLEAVE_MODE_COUNT
+};
+
+// Interleaved rendering around any ShaderToy program: the shader draws into a target
+// with one texel per shaded pixel (the wrapper's iInterleave maps texels to pixels),
+// then a reconstruction pass fills the full frame. Pixels shaded this frame are taken
+// as is; the others come from the previous frame, clamped to the range of this
+// frame's neighbours so moving content does not smear, or from the neighbours alone
+// when there is no history. While nothing moves the history is used unclamped, so a
+// still image is exact after 2 (or 4) frames.
+class InterleavedRenderer {
+public:
+    InterleavedRenderer();
+
+    // Compile the reconstruction pass - needs a current GL context
+    bool init();
+
+    void setMode(InterleaveMode value);
+    InterleaveMode getMode() const { return mode; }
+
+    // Advance the pattern and bind the target for this frame's pixels of a width x height
+    // frame. still = same program, time and mouse as the previous frame.
+    bool begin(int width, int height, bool still);
+
+    // The wrapper's iInterleave for this frame: pixel stride (xy) and offset (zw)
+    void getInterleave(float values[4]) const;
+
+    // Reconstruct the full frame and stretch it onto the screen
+    void resolve(GLuint quadVAO, int windowWidth, int windowHeight, GLuint screenFramebuffer);
+
+    // Drop the history (shader switch, mode change)
+    void reset() { historyValid = false; }
+
+    // Delete the targets (the owning context must be current)
+    void release();
+
+private:
+    InterleaveMode mode;
+    int phase;
+    bool historyValid;
+    bool still;
+    int current;
+    RenderTarget shaded;
+    RenderTarget frames[2];
+    ShaderManager reconstruct;
+};
+
+// Name of an interleave mode for options, logs and the HUD
+const char* getInterleaveModeName(InterleaveMode mode);
+
+// Parse "off", "checkerboard" or "quarter"; false if unknown
+bool parseInterleaveMode(const std::string& name, InterleaveMode& mode);
+
+#endif // INTERLEAVED_RENDER_H
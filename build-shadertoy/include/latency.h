@@ -0,0 +1,38 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "includes.h"
+
+// Input-to-present latency measurement.
+// For every frame that consumes input we take the oldest input event it contains
+// and measure the time from that event until the swap of the frame has completed.
+class LatencyTracker {
+public:
+    LatencyTracker();
+
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // Note an input event (SDL event timestamp) consumed by the frame being built.
+    // Events already counted for an earlier frame are ignored.
+    void onInput(Uint32 eventTimestampMs);
+
+    // Call once the swap of the frame has completed
+    void onFramePresented();
+
+    // Print the latency distribution collected so far
+    void printReport() const;
+
+    // Number of frames measured
+    size_t getSampleCount() const { return samples.size(); }
+
+private:
+    bool enabled;
+    bool hasPending;
+    Uint32 lastCountedMs;
+    float pendingAgeMs;        // Age of the oldest pending event when it was seen
+    Uint64 pendingSeenCounter; // Performance counter when it was seen
+    std::vector<float> samples;
+};
+
+#endif // LATENCY_H
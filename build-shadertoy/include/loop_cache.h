@@ -0,0 +1,90 @@
+#ifndef LOOP_CACHE_H
+#define LOOP_CACHE_H
+
+#include "includes.h"
+#include "accumulation.h"
+#include "render_target.h"
+#include "shader_manager.h"
+
+// Longest period the probe looks for, in seconds
+const float LOOP_PROBE_MAX_PERIOD = 20.0f;
+
+// Loop cache tuning
+struct LoopCacheConfig {
+    float framesPerSecond = 30.0f;      // Cached frames per second of the loop
+    size_t budgetBytes = 256u << 20;    // Texture memory for one loop; fewer frames per second if it is short
+    float settleSeconds = 0.5f;         // Mouse input has to rest this long before caching starts again
+};
+
+// Period a shader declares as "// loop-period: <seconds>", 0 if there is none
+float parseLoopPeriod(const std::string& shaderToyCode);
+
+// Smallest period (a multiple of 1/8 s up to maxPeriod) after which every frame of a
+// recorded sequence of 64x36 frames, two maxPeriods long, repeats; 0 if there is none.
+// The program is used with the mouse at rest.
+float probeLoopPeriod(ShaderManager& shader, GLuint quadVAO, float maxPeriod = LOOP_PROBE_MAX_PERIOD);
+
+// Frame cache for animations that repeat in iTime. The loop is split into equal
+// slots; the frame of a slot is rendered once, at the slot's start time, and stored
+// in a compressed texture (DXT1 where the driver has S3TC, 16-bit RGB otherwise)
+// that stays on the GPU. Every later frame in that slot is a textured quad. The first
+// loop fills the cache at the cost of a normal frame; after that the shader is not
+// run at all. Any input besides iTime (shader, program, size, mouse) drops the frames.
+class LoopFrameCache {
+public:
+    LoopFrameCache();
+    ~LoopFrameCache();
+
+    // Compile the playback pass - needs a current GL context
+    bool init();
+
+    void setConfig(const LoopCacheConfig& value);
+    const LoopCacheConfig& getConfig() const { return config; }
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // Whether this frame can come from the cache. Frames made for other inputs are
+    // dropped here; after a mouse change the shader renders normally until it settles.
+    bool begin(const AccumulationInputs& inputs, float period, float clockSeconds);
+
+    // Render the frame of the slot inputs.time falls in unless it is cached (the active
+    // program must be the one begin saw). Returns false if the budget holds fewer than
+    // two frames or the targets can't be created.
+    bool render(ShaderManager& shader, GLuint quadVAO, const AccumulationInputs& inputs, int frame);
+
+    // Draw the frame of the current slot over the screen framebuffer
+    void present(GLuint quadVAO, int windowWidth, int windowHeight, GLuint screenFramebuffer);
+
+    int getFramesFilled() const { return framesFilled; }
+    int getFrameCount() const { return static_cast<int>(frames.size()); }
+    size_t getBytes() const { return framesFilled * bytesPerFrame; }
+    bool isCompressed() const { return compressed; }
+    uint64_t getFramesPlayed() const { return framesPlayed; }
+    int getInvalidations() const { return invalidations; }
+
+    // Delete the frames and targets (the owning context must be current)
+    void release();
+
+private:
+    void clearFrames();
+
+    bool enabled;
+    LoopCacheConfig config;
+    ShaderManager playback;
+    RenderTarget capture;
+    GLuint pixelBuffer;             // Readback for the driver's DXT1 encoder
+    bool compressed;
+    AccumulationInputs key;         // Inputs of the cached frames, time and program left out
+    float period;
+    float settleStart;
+    GLuint program;                 // Program the cached frames were made with
+    std::vector<GLuint> frames;     // One texture per slot, 0 = not rendered yet
+    float slotSeconds;
+    size_t bytesPerFrame;
+    int framesFilled;
+    int currentSlot;
+    uint64_t framesPlayed;
+    int invalidations;
+};
+
+#endif // LOOP_CACHE_H
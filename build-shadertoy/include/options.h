@@ -0,0 +1,114 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "includes.h"
+#include "backend.h"
+#include "video_export.h"
+#include "tiled_render.h"
+#include "interleaved_render.h"
+
+// Command line options for the ShaderToy renderer
+struct RenderOptions {
+    // Chrome trace output (empty = tracing disabled)
+    std::string tracePath;
+
+    // Start with the performance overlay visible (toggle with F1)
+    bool showHud = false;
+
+    // Measure input-to-present latency and report the distribution at exit
+    bool measureLatency = false;
+
+    // Resample the mouse and update iMouse right before the draw call
+    bool lateLatch = false;
+
+    // Frame-time watchdog that degrades slow shaders (toggle with F5)
+    bool watchdog = true;
+    float frameBudgetMs = 100.0f;
+    int budgetFrames = 5;
+
+    // Start with the low-quality shader variants (toggle with F8)
+    bool lowQuality = false;
+
+    // Quality governor: shader variants chosen to fit the --target-fps budget (toggle with F9)
+    bool qualityGovernor = false;
+
+    // Progressive accumulation: samples per pixel of a still view, 0 = off (toggle with F10)
+    int accumulateSamples = 0;
+    // Start with iTime paused (toggle with Space)
+    bool paused = false;
+
+    // Interleaved rendering: shade half or a quarter of the pixels per frame (cycle with F11)
+    InterleaveMode interleaveMode = INTERLEAVE_OFF;
+
+    // Foveated rendering around the mouse: full-resolution radius and blend ring width
+    // in pixels, 0 = off / default (toggle with F12)
+    float foveaRadius = 0.0f;
+    float foveaFalloff = 0.0f;
+
+    // Time-sliced rendering: milliseconds of tiles per frame for slow shaders, 0 = off
+    float timeSliceMs = 0.0f;
+
+    // Depth prepass for ray marchers using the hook: block edge in pixels, 0 = off
+    int prepassBlock = 0;
+
+    // Static distance functions (SHADERTOY_STATIC_SDF) march far from surfaces through a
+    // baked volume, loaded from or added to the shader_sdfbake cache
+    bool bakedSdf = false;
+
+    // Loop cache for periodic shaders: period in seconds for every shader, or < 0 for
+    // the shader's own "// loop-period:" line and a probe without one; 0 = off
+    float loopPeriod = 0.0f;
+    float loopFps = 30.0f;          // Cached frames per second of the loop
+    int loopBudgetMb = 256;         // Texture memory for the frames of one loop
+
+    // Dynamic resolution: render scale follows the frame cost (toggle with F7)
+    bool dynamicResolution = false;
+    float targetFps = 60.0f;
+    float minRenderScale = 0.25f;
+
+    // Frames the driver may queue ahead, enforced with fences (1-3)
+    int framesInFlight = 2;
+
+    // Where frames are rendered; the offscreen backends need no display
+    BackendType backend = BACKEND_WINDOW;
+
+    // Output size (initial window size, or the offscreen target size)
+    int width = 1440;
+    int height = 720;
+
+    // Shader to start with (0-based index)
+    int startShader = 0;
+
+    // Stop after this many frames (0 = run until quit; offscreen default 1)
+    int frameCount = -1;
+
+    // Write the last frame as a binary PPM image
+    std::string outputPath;
+
+    // Write every frame as <prefix>_NNNNNN.ppm (read back asynchronously)
+    std::string dumpFramesPrefix;
+
+    // Publish every frame into this POSIX shared-memory ring, e.g. /shadertoy_frames
+    std::string sharedMemoryName;
+
+    // Offline video export of the start shader at --size (empty = off, "-" = stdout)
+    std::string exportPath;
+    VideoFormat exportFormat = VIDEO_Y4M;
+    int exportFps = 60;
+    float exportSeconds = 10.0f;
+    int exportWorkers = 1;          // Offscreen contexts rendering the export in parallel
+    bool exportScaling = false;     // Also time 1, 2, 4 ... contexts and report the scaling
+
+    // Tiled still of the start shader at --size, any size (empty = off)
+    std::string posterPath;
+    int tileSize = DEFAULT_TILE_SIZE;
+    float posterTime = 10.0f;
+};
+
+// Parse the command line; returns false (after printing usage) on bad input
+bool parseOptions(int argc, char* argv[], RenderOptions& options);
+
+// Print the supported command line options
+void printUsage(const char* programName);
+
+#endif // OPTIONS_H
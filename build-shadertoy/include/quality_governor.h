@@ -0,0 +1,73 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include "includes.h"
+#include <map>
+
+// Quality governor tuning
+struct QualityGovernorConfig {
+    float budgetMs = 1000.0f / 60.0f;   // Frame cost the chosen level must fit
+    float hysteresis = 0.15f;           // A higher level must fit budget * (1 - this) to be chosen again
+    int sampleFrames = 30;              // Frames measured at a level before deciding
+};
+
+// Picks a quality level (index into a shader's variant list, 0 = highest quality)
+// per shader. The cost of each variant is measured on this machine, per megapixel so
+// it carries over between window sizes, and kept on disk keyed by the GL renderer,
+// so the next launch starts at the right level. A level is left when its predicted
+// cost at the window size exceeds the budget; a higher one is chosen only when its
+// measured cost fits the budget with hysteresis, so the choice does not oscillate.
+class QualityGovernor {
+public:
+    QualityGovernor();
+
+    void setConfig(const QualityGovernorConfig& value) { config = value; }
+    const QualityGovernorConfig& getConfig() const { return config; }
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // Costs measured on this machine in earlier runs; other machines' entries are kept
+    // for save(). A missing file is not an error.
+    bool load(const std::string& filePath, const std::string& machineKey);
+    bool save(const std::string& filePath) const;
+
+    // Level for the next frame of a shader; levelKeys are the variants' define keys
+    int getLevel(const std::string& shaderName, const std::vector<std::string>& levelKeys, int windowPixels);
+
+    // Cost of a frame rendered at level with renderPixels pixels (GPU time, or CPU
+    // wall time where there are no GPU timers)
+    void reportFrame(const std::string& shaderName, const std::vector<std::string>& levelKeys, int level,
+                     float costMs, int renderPixels, int windowPixels);
+
+    // Wait for the timings to settle again (shader switch, resize)
+    void reset(const std::string& shaderName);
+
+private:
+    struct Measurement {
+        float msPerMegapixel;
+        int samples;
+    };
+    struct ShaderState {
+        int level = -1;
+        int frames = 0;
+        int settleFrames = 0;
+    };
+
+    QualityGovernorConfig config;
+    bool enabled;
+    std::string machine;
+    std::map<std::string, Measurement> costs;       // "shader\tvariant" on this machine
+    std::map<std::string, ShaderState> states;
+    std::vector<std::string> otherMachineLines;
+
+    const Measurement* findCost(const std::string& shaderName, const std::string& levelKey) const;
+    int pickLevel(const std::string& shaderName, const std::vector<std::string>& levelKeys, int windowPixels) const;
+};
+
+// GL vendor, renderer and version of the current context, the governor's machine key
+std::string getQualityMachineKey();
+
+// Name of a quality level for logs and the HUD
+const char* getQualityLevelName(int level, int levelCount);
+
+#endif // QUALITY_GOVERNOR_H
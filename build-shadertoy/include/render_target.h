@@ -0,0 +1,59 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include "includes.h"
+
+// Offscreen color target (FBO + texture) used to render at a size other than the window
+class RenderTarget {
+public:
+    RenderTarget();
+    ~RenderTarget();
+
+    // (Re)create the target if the size or format changed; returns false if the FBO is incomplete
+    bool resize(int newWidth, int newHeight, GLenum newInternalFormat = GL_RGBA8);
+
+    // Bind as draw framebuffer and set the viewport to the whole target
+    void bind() const;
+
+    // Stretch the target onto the screen framebuffer (linear filtering)
+    void blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer = 0) const;
+
+    GLuint getFramebuffer() const { return framebuffer; }
+    GLuint getTexture() const { return texture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool isValid() const { return framebuffer != 0; }
+
+    // Delete the GL objects (the owning context must be current)
+    void release();
+
+private:
+    GLuint framebuffer;
+    GLuint texture;
+    int width;
+    int height;
+    GLenum internalFormat;
+};
+
+// Keeps the draw framebuffer and viewport bound when it is created and restores them
+// when it goes out of scope. Creating a RenderTarget binds framebuffer 0, so code that
+// renders into its own targets in the middle of a frame opens one of these first.
+class FramebufferScope {
+public:
+    FramebufferScope() : framebuffer(0) {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+    }
+    ~FramebufferScope() {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+    FramebufferScope(const FramebufferScope&) = delete;
+    FramebufferScope& operator=(const FramebufferScope&) = delete;
+
+private:
+    GLint framebuffer;
+    GLint viewport[4];
+};
+
+#endif // RENDER_TARGET_H
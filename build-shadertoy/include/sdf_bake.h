@@ -0,0 +1,83 @@
+#ifndef SDF_BAKE_H
+#define SDF_BAKE_H
+
+#include "includes.h"
+#include "shader_manager.h"
+#include <cstdint>
+
+// Bump when the file layout or the way distances are sampled changes
+const uint32_t SDF_BAKE_VERSION = 1;
+
+// Samples along the longest side of the bounds
+const int DEFAULT_SDF_BAKE_RESOLUTION = 96;
+
+// Region and density of a bake
+struct SdfBakeSettings {
+    float boundsMin[3] = {-1.0f, -1.0f, -1.0f};
+    float boundsMax[3] = {1.0f, 1.0f, 1.0f};
+    int resolution = DEFAULT_SDF_BAKE_RESOLUTION;
+
+    bool operator==(const SdfBakeSettings& other) const;
+};
+
+// Distances at the nodes of a grid of cubic cells from boundsMin on (x fastest, then
+// y, then z); the last node can lie a little beyond boundsMax
+struct SdfVolume {
+    SdfBakeSettings settings;
+    uint64_t sourceHash = 0;
+    int size[3] = {0, 0, 0};
+    float voxelSize = 0.0f;
+    std::vector<float> distances;
+};
+
+// Whether ShaderToy code defines a static distance function to bake: SHADERTOY_STATIC_SDF(p)
+bool shaderHasStaticSdf(const std::string& shaderToyCode);
+
+// Bounds the code declares as "// sdf-bounds: x0 y0 z0 x1 y1 z1"; false if there are none
+bool parseSdfBounds(const std::string& shaderToyCode, SdfBakeSettings& settings);
+
+// Cache file of a shader's bake, e.g. ../shader9.sdf.cache
+std::string getSdfCachePath(const std::string& cacheDir, const std::string& name);
+
+// Evaluate SHADERTOY_STATIC_SDF at every node, one z slice per draw (needs a current GL context)
+bool bakeSdfVolume(const std::string& shaderToyCode, const SdfBakeSettings& settings, GLuint quadVAO,
+                   SdfVolume& volume);
+
+// Write through a temporary file, so a crash never leaves half a volume
+bool saveSdfVolume(const std::string& filePath, const SdfVolume& volume);
+
+// Load a bake made from the source with this hash (with the settings it was made with);
+// false if it is missing, stale or damaged
+bool loadSdfVolume(const std::string& filePath, uint64_t sourceHash, SdfVolume& volume);
+
+// The cached bake of the code, or a new one with settings that is then cached
+bool loadOrBakeSdfVolume(const std::string& filePath, const std::string& shaderToyCode,
+                         const SdfBakeSettings& settings, GLuint quadVAO, SdfVolume& volume);
+
+// A volume as the 3D texture behind the wrapper's shadertoyBakedDistance
+class SdfVolumeTexture {
+public:
+    SdfVolumeTexture();
+    ~SdfVolumeTexture();
+    // Owns the texture, so copies would delete it twice
+    SdfVolumeTexture(const SdfVolumeTexture&) = delete;
+    SdfVolumeTexture& operator=(const SdfVolumeTexture&) = delete;
+
+    bool upload(const SdfVolume& volume);
+    bool isValid() const { return texture != 0; }
+
+    // Bind to SHADERTOY_SDF_VOLUME_UNIT and enable it in the shader's current program
+    void bind(ShaderManager& shader) const;
+    void unbind(ShaderManager& shader) const;
+
+    // Delete the texture (the owning context must be current)
+    void release();
+
+private:
+    GLuint texture;
+    float boundsMin[3];
+    float boundsMax[3];
+    float error;
+};
+
+#endif // SDF_BAKE_H
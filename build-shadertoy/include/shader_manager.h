@@ -2,13 +2,51 @@
 #define SHADER_MANAGER_H
 
 #include "includes.h"
+#include <map>
 
 
 // Default vertex shader for ShaderToy-style rendering
 extern const char* defaultVertexShader;
 
-// Create a ShaderToy-compatible fragment shader
-std::string createShaderToyFragmentShader(const std::string& shaderToyCode);
+// Load a shader source file (empty string on failure)
+std::string loadShaderFromFile(const std::string& filePath);
+
+// Quality knobs to override in a ShaderToy source (name -> value)
+typedef std::map<std::string, std::string> ShaderDefines;
+
+// Low-quality knobs per shader, index 0 = shader1.glsl (empty if a shader has none)
+extern const std::vector<ShaderDefines> SHADER_LOW_QUALITY_DEFINES;
+extern const std::vector<ShaderDefines> SHADER_MEDIUM_QUALITY_DEFINES;
+// Knobs that turn off a shader's own supersampling (empty if it has none)
+extern const std::vector<ShaderDefines> SHADER_SINGLE_SAMPLE_DEFINES;
+
+// Quality levels of a shader, highest first: the source as written, then the
+// medium and low-quality knobs it has
+std::vector<ShaderDefines> getShaderQualityLevels(int shader);
+
+// Override "#define NAME value" lines and "const type NAME = value;" declarations;
+// names the source doesn't declare are added as #defines in front of it
+std::string applyShaderDefines(const std::string& shaderToyCode, const ShaderDefines& defines);
+
+// Create a ShaderToy-compatible fragment shader; mainSource replaces the main() that calls
+// mainImage (tools that evaluate other functions of the shader)
+std::string createShaderToyFragmentShader(const std::string& shaderToyCode, const ShaderDefines& defines = ShaderDefines(),
+                                          const char* mainSource = nullptr);
+
+// Texture unit of the wrapper's baked distance volume (iSdfVolume); samplers of different
+// types may not share a unit even when nothing is bound, so it is set with the uniforms
+const int SHADERTOY_SDF_VOLUME_UNIT = 4;
+
+// Key of a define set: "NAME=VALUE" pairs in name order, "" for the source as written
+std::string getShaderDefinesKey(const ShaderDefines& defines);
+
+// Compile state of a shader variant
+enum VariantState {
+    VARIANT_QUEUED,     // Requested, compile not started yet
+    VARIANT_COMPILING,  // Compile and link submitted, result not collected yet
+    VARIANT_READY,
+    VARIANT_FAILED
+};
 
 
 
@@ -20,6 +58,28 @@ public:
     
     // Load shaders from strings
     bool loadFromStrings(const std::string& vertexSource, const std::string& fragmentSource);
+
+    // Compile ShaderToy code with the default vertex shader, and keep it for variants
+    bool loadShaderToy(const std::string& shaderToyCode);
+
+    // Variants: the ShaderToy code with a define set applied, one program per set.
+    // requestVariant queues a compile; selectVariant makes the variant the program
+    // used from now on once it is ready (false keeps the current program). The empty
+    // set is the base program.
+    VariantState requestVariant(const ShaderDefines& defines);
+    bool selectVariant(const ShaderDefines& defines);
+    // Collect finished compiles and, if allowed, start the next queued one; true if one
+    // was started. With KHR_parallel_shader_compile collecting never waits for the driver;
+    // without it the compile and link of a started variant run on this thread.
+    bool pollVariants(bool startNext = true);
+    // Compile a variant right away (startup, offscreen runs); false if it fails
+    bool compileVariant(const ShaderDefines& defines);
+    const std::string& getSelectedVariant() const { return selectedVariant; }
+    
+    // Program binaries (GL 4.1 / ARB_get_program_binary): lets more contexts on the same
+    // driver skip the compile. Both return false if unsupported or the driver rejects it.
+    bool getProgramBinary(std::vector<unsigned char>& binary, GLenum& format) const;
+    bool loadFromBinary(const std::vector<unsigned char>& binary, GLenum format);
     
     // Use the shader program
     void use();
@@ -33,14 +93,60 @@ public:
     
     // ShaderToy specific functions
     void setupShaderToyUniforms(int windowWidth, int windowHeight, float time, float deltaTime, int frame, int mouseX, int mouseY, bool mouseDown);
+
+    // Update only iMouse (used to late-latch the mouse right before the draw)
+    void setupShaderToyMouse(int windowHeight, int mouseX, int mouseY, bool mouseDown);
+    
+    // Draw only the tile at x, y (pixels from the bottom-left) of size width x height
+    // of the iResolution image, into a viewport of the tile's size; 0 x 0 = whole frame
+    void setupShaderToyTile(int x, int y, int width, int height);
+
+    // Offset every pixel's sample by x, y pixels (progressive accumulation); 0, 0 = centre
+    void setupShaderToyJitter(float x, float y);
+
+    // Shade one pixel per stride cell into a smaller target (interleaved rendering):
+    // stride (2, 1) = checkerboard, offset x = row phase; (2, 2) = quarter; 0 = off
+    void setupShaderToyInterleave(float strideX, float strideY, float offsetX, float offsetY);
+
+    // Depth prepass hook: mode 1 = this draw is the prepass, 2 = march from the prepass
+    // depth bound to textureUnit, 0 = off; blocks of blockSize x blockSize pixels
+    void setupShaderToyPrepass(int mode, int blockSize, int textureUnit);
+
+    // Baked distance volume bound to SHADERTOY_SDF_VOLUME_UNIT covering boundsMin..boundsMax,
+    // sampling error in scene units; enabled = false turns shadertoyBakedDistance off
+    void setupShaderToySdfVolume(bool enabled, const float boundsMin[3], const float boundsMax[3], float error);
     
     // Get the program ID
     GLuint getProgramID() const { return programID; }
+    // Whether the program animates by itself: it reads iTime, iTimeDelta or iFrame (the
+    // linker drops uniforms the code never uses)
+    bool readsTime() const;
+
+    // Time spent in the last loadFromStrings: both shader compiles, and the link
+    float getCompileMs() const { return compileMs; }
+    float getLinkMs() const { return linkMs; }
 
 private:
-    GLuint programID;
+    struct Variant {
+        ShaderDefines defines;
+        VariantState state;
+        GLuint program;
+        GLuint vertexShader;
+        GLuint fragmentShader;
+    };
+
+    GLuint programID;     // Program in use: the base program or a variant
+    GLuint baseProgramID;
+    float compileMs;
+    float linkMs;
+    std::string shaderToyCode;
+    std::map<std::string, Variant> variants;
+    std::string selectedVariant;
     bool checkCompileErrors(GLuint shader, const std::string& type);
     bool checkLinkErrors(GLuint program);
+    void releasePrograms();
+    void startVariant(Variant& variant);
+    void collectVariant(Variant& variant, bool wait);
 };
 
 // Helper function to create a full-screen quad for rendering
@@ -0,0 +1,107 @@
+#ifndef SHARED_FRAMES_H
+#define SHARED_FRAMES_H
+
+#include "includes.h"
+#include <atomic>
+#include <cstdint>
+
+// Frames published into a POSIX shared-memory ring for other processes (compositor,
+// LED wall driver). Readers map the object and use the pixels in place.
+//
+// Layout of the object (all offsets from its start):
+//   SharedFrameRingHeader
+//   SharedFrameSlot[slotCount]
+//   pixel slots, slotBytes each, starting at dataOffset (page aligned)
+//
+// Each slot is a seqlock: its sequence is odd while the renderer writes it and even
+// (2 * frame sequence) once it is complete. A reader copies or uses the pixels and
+// then checks the sequence is unchanged; if not, the renderer lapped it. The renderer
+// never waits for readers. latestSequence is also a futex word on Linux: readers can
+// sleep in FUTEX_WAIT on it and are woken for every new frame.
+
+const uint32_t SHARED_FRAMES_VERSION = 1;
+const uint32_t SHARED_FRAMES_FORMAT_RGBA8 = 0x41424752; // 'RGBA' little-endian, top row first
+const int SHARED_FRAMES_DEFAULT_SLOTS = 3;
+
+struct SharedFrameSlot {
+    std::atomic<uint64_t> sequence;     // Seqlock, see above
+    uint64_t timestampNs;               // steady_clock time the frame was finished
+    uint64_t frameIndex;                // Renderer frame number
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                    // Bytes per row
+    uint32_t format;                    // SHARED_FRAMES_FORMAT_*
+    uint32_t bytes;                     // Valid bytes in the pixel slot
+    uint32_t reserved;
+};
+
+struct SharedFrameRingHeader {
+    char magic[8];                      // "STFRAMES"
+    uint32_t version;
+    uint32_t slotCount;
+    uint64_t slotBytes;
+    uint64_t dataOffset;
+    std::atomic<uint32_t> latestSequence;   // Sequence of the newest complete frame (futex word)
+    uint32_t latestSlot;
+    std::atomic<uint32_t> writerAlive;      // 0 once the renderer has shut down
+    uint32_t reserved;
+};
+
+// Renderer side
+class SharedFrameWriter {
+public:
+    SharedFrameWriter();
+    ~SharedFrameWriter();
+
+    // Create (or replace) the shared-memory object, e.g. "/shadertoy_frames", with
+    // slots big enough for maxWidth x maxHeight RGBA frames
+    bool open(const std::string& name, int maxWidth, int maxHeight, int slotCount = SHARED_FRAMES_DEFAULT_SLOTS);
+
+    // Copy one frame (tightly packed RGBA, top row first) into the next slot and wake
+    // the readers. Never blocks; frames bigger than a slot are counted and skipped.
+    bool publish(const std::vector<unsigned char>& pixels, int width, int height, uint64_t frameIndex);
+
+    // Mark the writer gone, unmap and unlink the object
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t getPublished() const { return published; }
+    uint64_t getSkipped() const { return skipped; }
+
+private:
+    std::string name;
+    SharedFrameRingHeader* header;
+    SharedFrameSlot* slots;
+    unsigned char* data;
+    size_t mappedBytes;
+    uint32_t sequence;
+    uint64_t published;
+    uint64_t skipped;
+};
+
+// Consumer side (other processes): maps the ring read-only and hands out pointers into it
+class SharedFrameReader {
+public:
+    SharedFrameReader();
+    ~SharedFrameReader();
+
+    bool open(const std::string& name);
+    void close();
+
+    // Wait up to timeoutMs for a frame newer than the last one returned. On success
+    // pixels points into the shared mapping; call isStillValid(slot) after using it.
+    bool waitFrame(int timeoutMs, const SharedFrameSlot*& slot, const unsigned char*& pixels);
+
+    // True if the renderer has not overwritten the slot since waitFrame returned it
+    bool isStillValid(const SharedFrameSlot* slot) const;
+
+    bool isWriterAlive() const;
+
+private:
+    const SharedFrameRingHeader* header;
+    size_t mappedBytes;
+    uint32_t lastSequence;
+    uint64_t slotSequence;
+};
+
+#endif // SHARED_FRAMES_H
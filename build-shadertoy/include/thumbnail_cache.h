@@ -0,0 +1,46 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include "includes.h"
+#include <cstdint>
+#include <map>
+
+// Bump when the file layout or the way thumbnails are rendered changes
+const uint32_t THUMBNAIL_CACHE_VERSION = 1;
+
+// One preview image: tightly packed RGB, top row first
+struct Thumbnail {
+    std::string name;       // Library name, e.g. "shader5"
+    uint64_t sourceHash;    // Hash of everything the image depends on (source, knobs, size)
+    float time;             // iTime it was rendered at
+    int width;
+    int height;
+    std::vector<unsigned char> rgb;
+};
+
+// All thumbnails of a library in a single file: a header and an index of
+// (name, hash, time, size, offset) entries, followed by the pixel blocks. A browser
+// can read the index and seek to one image without loading the rest.
+class ThumbnailCache {
+public:
+    // Load every entry; a missing file is an empty cache, a bad one is reported and ignored
+    bool load(const std::string& filePath);
+
+    // Write the cache through a temporary file, so a crash never leaves half a cache
+    bool save(const std::string& filePath) const;
+
+    // Entry for the name if its hash still matches (nullptr = render it again)
+    const Thumbnail* find(const std::string& name, uint64_t sourceHash) const;
+
+    void put(const Thumbnail& thumbnail);
+    void remove(const std::string& name);
+    const std::map<std::string, Thumbnail>& getEntries() const { return entries; }
+
+    // Read a single thumbnail through the index
+    static bool readOne(const std::string& filePath, const std::string& name, Thumbnail& thumbnail);
+
+private:
+    std::map<std::string, Thumbnail> entries;
+};
+
+#endif // THUMBNAIL_CACHE_H
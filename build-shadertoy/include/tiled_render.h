@@ -0,0 +1,23 @@
+#ifndef TILED_RENDER_H
+#define TILED_RENDER_H
+
+#include "includes.h"
+#include "shader_manager.h"
+
+// Default tile edge; also capped by GL_MAX_RENDERBUFFER_SIZE / GL_MAX_VIEWPORT_DIMS
+const int DEFAULT_TILE_SIZE = 2048;
+
+struct TiledRenderSettings {
+    std::string path;       // Binary PPM (must be seekable)
+    int width = 16384;      // Virtual image size, may exceed the maximum framebuffer size
+    int height = 16384;
+    int tileSize = DEFAULT_TILE_SIZE;
+    float time = 10.0f;     // iTime of the still
+};
+
+// Render one still of any size in tiles. Every tile is drawn with the full virtual
+// iResolution and its own iTile rectangle, read back asynchronously and written straight to
+// its place in the file, so memory use depends on the tile size, not the image size.
+bool renderTiled(ShaderManager& shader, GLuint quadVAO, const TiledRenderSettings& settings);
+
+#endif // TILED_RENDER_H
@@ -0,0 +1,67 @@
+#ifndef TIME_SLICED_RENDER_H
+#define TIME_SLICED_RENDER_H
+
+#include "includes.h"
+#include "accumulation.h"
+#include "render_target.h"
+#include "shader_manager.h"
+
+// Time-sliced rendering for shaders that cost more than a frame: the image is split
+// into tiles and every frame draws only as many as fit the time budget, each limited
+// by the scissor rectangle, into a pending target. The uniforms are those of the frame
+// the image started in, so the tiles fit together. Once all tiles are in, the pending
+// image becomes the presented one; until then the last complete image stays on screen,
+// and the event pump and the HUD keep running at the normal frame rate.
+class TimeSlicedRenderer {
+public:
+    TimeSlicedRenderer();
+
+    // Milliseconds of shader work per frame, 0 = off
+    void setBudgetMs(float value);
+    float getBudgetMs() const { return budgetMs; }
+    bool isEnabled() const { return budgetMs > 0.0f; }
+
+    // Draw the next tiles of the image for inputs (a new one starts when the last is
+    // complete and the inputs changed, or at once if the program or size changed).
+    // The active program must be in use; its uniforms are set here.
+    bool render(ShaderManager& shader, GLuint quadVAO, const AccumulationInputs& inputs, float deltaTime, int frame);
+
+    // Copy the last complete image (or the one in progress if there is none for the
+    // current program and size) to the screen
+    void blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer) const;
+
+    // Progress of the image in progress, for the HUD
+    int getTilesDone() const { return nextTile; }
+    int getTileCount() const { return columns * rows; }
+
+    // Completed images and how long the last one took from first to last tile
+    int getImagesCompleted() const { return imagesCompleted; }
+    float getLastImageSeconds() const { return lastImageSeconds; }
+    int getTileSize() const { return tileSize; }
+
+    // Delete the targets (the owning context must be current)
+    void release();
+
+private:
+    void startImage(const AccumulationInputs& inputs, float deltaTime, int frame);
+
+    float budgetMs;
+    RenderTarget targets[2];
+    int pending;                    // Index of the target being filled
+    bool presentedValid;
+    AccumulationInputs presentedInputs;
+    AccumulationInputs imageInputs;
+    float imageDeltaTime;
+    int imageFrame;
+    bool imageActive;
+    uint64_t imageStartNs;
+    int tileSize;
+    int columns;
+    int rows;
+    int nextTile;
+    double msPerPixel;              // Measured cost, picks the tile size of the next image
+    int imagesCompleted;
+    float lastImageSeconds;
+};
+
+#endif // TIME_SLICED_RENDER_H
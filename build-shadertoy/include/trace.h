@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "includes.h"
+#include <atomic>
+#include <cstdint>
+
+// Chrome trace / Perfetto recorder for the frame phases.
+// Every thread records into its own fixed-size ring buffer, so recording an event
+// never takes a lock. The buffers are written out as Chrome trace JSON on demand.
+
+// One complete ("ph":"X") event
+struct TraceEvent {
+    const char* name;       // Must point to a string literal
+    const char* category;   // Must point to a string literal
+    uint64_t startNs;       // Start time on the trace clock
+    uint64_t durationNs;    // Duration in nanoseconds
+    uint32_t track;         // Thread track, or TRACE_GPU_TRACK
+};
+
+// Track id used for GPU timer results so they show up as their own row
+const uint32_t TRACE_GPU_TRACK = 1000;
+
+// Enable or disable recording (disabled by default)
+void traceSetEnabled(bool enabled);
+bool traceIsEnabled();
+
+// Current time on the trace clock in nanoseconds
+uint64_t traceNowNs();
+
+// Record a finished CPU event on the calling thread's buffer
+void traceRecord(const char* name, const char* category, uint64_t startNs, uint64_t durationNs);
+
+// Record a finished GPU event (timestamps already converted to the trace clock)
+void traceRecordGpu(const char* name, uint64_t startNs, uint64_t durationNs);
+
+// Write all recorded events as Chrome trace JSON
+bool traceWriteJson(const std::string& filePath);
+
+// Scoped CPU zone - records its lifetime as one event
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category = "cpu")
+        : name(name), category(category), startNs(traceIsEnabled() ? traceNowNs() : 0) {
+    }
+    ~TraceScope() {
+        if (startNs != 0) {
+            traceRecord(name, category, startNs, traceNowNs() - startNs);
+        }
+    }
+
+private:
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,55 @@
+#ifndef VIDEO_EXPORT_H
+#define VIDEO_EXPORT_H
+
+#include "includes.h"
+#include "shader_manager.h"
+#include "async_readback.h"
+#include <atomic>
+#include <cstdio>
+
+// Stream container written by the exporter
+enum VideoFormat {
+    VIDEO_Y4M,   // YUV4MPEG2, 4:2:0 BT.601 limited range (ffmpeg -i out.y4m ...)
+    VIDEO_RAW    // Headerless rgb24 (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r FPS -i ...)
+};
+
+// Parse "y4m" or "raw"
+bool parseVideoFormat(const std::string& name, VideoFormat& format);
+
+struct VideoExportSettings {
+    std::string path;       // File, named pipe, or "-" for stdout
+    VideoFormat format = VIDEO_Y4M;
+    int width = 1920;
+    int height = 1080;
+    int fps = 60;
+    float durationSeconds = 10.0f;
+};
+
+// Writes frames to a file or pipe; used from the readback consumer thread
+class VideoWriter {
+public:
+    VideoWriter();
+    ~VideoWriter();
+
+    bool open(const VideoExportSettings& settings);
+    bool writeFrame(const ReadbackFrame& frame);
+    void close();
+
+    uint64_t getBytesWritten() const { return bytesWritten; }
+    bool hasFailed() const { return failed; }
+
+private:
+    std::FILE* file;
+    bool ownsFile;
+    std::atomic<bool> failed;       // Set on the consumer thread, read by the render loop
+    VideoFormat format;
+    uint64_t bytesWritten;
+    std::vector<unsigned char> buffer;
+};
+
+// Render the shader at a fixed frame rate with a deterministic clock (iTime = frame / fps)
+// into an offscreen target of the requested size, and stream the frames from a writer
+// thread. Runs as fast as the GPU allows; prints the achieved frames/s.
+bool exportVideo(ShaderManager& shader, GLuint quadVAO, const VideoExportSettings& settings);
+
+#endif // VIDEO_EXPORT_H
@@ -0,0 +1,70 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "includes.h"
+
+// Degradation steps, from full quality to not rendering at all
+enum DegradeLevel {
+    DEGRADE_NONE = 0,       // Full resolution, full quality
+    DEGRADE_RENDER_SCALE,   // Reduced render scale, upscaled to the window
+    DEGRADE_LOW_QUALITY,    // Low-quality shader variant (or a further reduced scale) at reduced render scale
+    DEGRADE_FROZEN,         // Keep presenting the last rendered frame
+    DEGRADE_LEVEL_COUNT
+};
+
+// Watchdog tuning
+struct WatchdogConfig {
+    float budgetMs = 100.0f;         // Frame cost considered too slow
+    int overBudgetFrames = 5;        // Consecutive slow frames before stepping down
+    float renderScale = 0.5f;        // Render scale used from DEGRADE_RENDER_SCALE on
+    float recoverFraction = 0.6f;    // A probe must cost less than budget * this to step up
+    float probeIntervalSeconds = 2.0f;    // First probe delay after stepping down
+    float maxProbeIntervalSeconds = 16.0f; // Probe backoff limit
+    float relapseSeconds = 5.0f;     // Falling back this soon after a recovery doubles the probe interval
+};
+
+// Tracks frame cost per shader program and steps quality down when the budget is
+// exceeded for several frames in a row. Recovery is tested with single probe frames
+// rendered one level up, so a frozen shader can come back once there is headroom.
+class FrameWatchdog {
+public:
+    FrameWatchdog();
+
+    void setConfig(const WatchdogConfig& value) { config = value; }
+    const WatchdogConfig& getConfig() const { return config; }
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // Level the next frame of this program should be rendered at
+    DegradeLevel getLevel(int program) const;
+
+    // True if the next frame should be a recovery probe at getLevel() - 1
+    bool shouldProbe(int program, float nowSeconds) const;
+
+    // Report the cost of a frame rendered at renderedLevel (probe = it was a recovery probe)
+    void reportFrame(int program, const std::string& programName, DegradeLevel renderedLevel,
+                     bool probe, float costMs, float nowSeconds);
+
+private:
+    struct ProgramState {
+        DegradeLevel level = DEGRADE_NONE;
+        int overCount = 0;
+        int settleFrames = 0;
+        float nextProbeSeconds = 0.0f;
+        float probeIntervalSeconds = 0.0f;
+        float recoveredSeconds = -1.0e9f;
+    };
+
+    bool enabled;
+    WatchdogConfig config;
+    std::vector<ProgramState> states;
+
+    ProgramState& getState(int program);
+    void changeLevel(int program, const std::string& programName, DegradeLevel newLevel,
+                     float costMs, float nowSeconds, const char* reason);
+};
+
+// Name of a degradation level for logs and the HUD
+const char* getDegradeLevelName(DegradeLevel level);
+
+#endif // WATCHDOG_H
@@ -1,3 +1,6 @@
+// mod(2.*iTime, 10.) below repeats every 5 s; the loop cache uses this with --loop-cache auto
+// loop-period: 5
+
 float segment(vec2 p, vec2 a, vec2 b) {
     p -= a;
     b -= a;
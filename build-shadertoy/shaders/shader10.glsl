@@ -94,13 +94,25 @@ float rand(vec2 co){
 }
 
 vec4 rayMarch(in vec3 from, in vec3 dir, in vec2 fragCoord) {
-	// Add some noise to prevent banding
-	float totalDistance = Jitter*rand(fragCoord.xy+vec2(iTime));
 	vec3 dir2 = dir;
+	// Depth prepass: one cone per block of pixels (the perspective bend rotates
+	// all rays alike, so the cone keeps its width)
+	if (shadertoyPrepass()) {
+		float t = 0.0;
+		for (int i=0; i < MaxSteps; i++) {
+			dir.zy = rotate(dir2.zy,t*cos( iTime/4.0)*NonLinearPerspective);
+			if (!shadertoyConeStep(t, DE(from + t * dir)*FudgeFactor, 2.0/iResolution.y, 0.0)) break;
+		}
+		shadertoyPrepassResult(t);
+		return vec4(0.0);
+	}
+	// Add some noise to prevent banding
+	float totalDistance = shadertoyRayStart(Jitter*rand(fragCoord.xy+vec2(iTime)));
 	float distance;
-	int steps = 0;
+	// The steps of the prepass count for the AO and against the budget
+	int steps = min(int(shadertoyRaySteps()), MaxSteps - 1);
 	vec3 pos;
-	for (int i=0; i < MaxSteps; i++) {
+	for (int i=steps; i < MaxSteps; i++) {
 		// Non-linear perspective applied here.
 		dir.zy = rotate(dir2.zy,totalDistance*cos( iTime/4.0)*NonLinearPerspective);
 		
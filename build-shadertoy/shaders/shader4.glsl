@@ -416,6 +416,17 @@ vec2 raycast( in vec3 ro, in vec3 rd )
     float tmin = 1.0;
     float tmax = 20.0;
 
+    // depth prepass: one cone per block of pixels, over the whole range since
+    // the box clip differs between the rays of a block
+    if( shadertoyPrepass() )
+    {
+        float t = tmin;
+        for( int i=0; i<128 && t<tmax; i++ )
+            if( !shadertoyConeStep( t, map( ro+rd*t ).x, 0.8/iResolution.y, 0.0 ) ) break;
+        shadertoyPrepassResult( t );
+        return res;
+    }
+
     // raytrace floor plane
     float tp1 = (0.0-ro.y)/rd.y;
     if( tp1>0.0 )
@@ -433,7 +444,7 @@ vec2 raycast( in vec3 ro, in vec3 rd )
         tmin = max(tb.x,tmin);
         tmax = min(tb.y,tmax);
 
-        float t = tmin;
+        float t = shadertoyRayStart( tmin );
         for( int i=0; i<70 && t<tmax; i++ )
         {
             vec2 h = map( ro+rd*t );
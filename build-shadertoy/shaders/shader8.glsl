@@ -256,8 +256,18 @@ vec4 raycast( in vec3 ro, in vec3 rd, float time )
     if( tp>0.0 ) tmax = min( tmax, tp );
 	#endif    
     
+    // depth prepass: one cone per block of pixels
+    if( shadertoyPrepass() )
+    {
+        float t = tmin;
+        for( int i=0; i<256 && t<tmax; i++ )
+            if( !shadertoyConeStep( t, map( ro+rd*t, time ).x, 1.1112/iResolution.y, 0.0 ) ) break;
+        shadertoyPrepassResult( t );
+        return res;
+    }
+
     // raymarch scene
-    float t = tmin;
+    float t = shadertoyRayStart( tmin );
     for( int i=0; i<256 && t<tmax; i++ )
     {
         vec4 h = map( ro+rd*t, time );
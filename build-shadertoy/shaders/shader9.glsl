@@ -7,6 +7,9 @@
 #define SHADOW_SMOOTHNESS 256.0
 #define SHADOW_DARKNESS 0.75
 
+// Region of the scene shader_sdfbake samples distf over
+// sdf-bounds: -26 -26 -14 26 26 16
+
 // Distance functions from iquilezles.org
 float fSubtraction(float a, float b) {return max(-a,b);}
 float fIntersection(float d1, float d2) {return max(d1,d2);}
@@ -37,6 +40,9 @@ float distf(vec3 p)
 	return d;
 }
 
+// The scene does not move, so its distances can be baked once
+#define SHADERTOY_STATIC_SDF(p) distf(p)
+
 
 vec3 normal(vec3 p)
 {
@@ -55,14 +61,29 @@ vec4 raymarch(vec3 from, vec3 increment)
 	const float minDist = 0.001;
 	const int maxIter = RAYMARCH_ITERATIONS;
 	
-	float dist = 0.0;
+	// Depth prepass: one cone per block of pixels, widened for the jitter of p
+	if (shadertoyPrepass()) {
+		float t = 0.0;
+		for(int i = 0; i < maxIter && t < maxDist; i++) {
+			vec3 pos = from + increment * t;
+			float baked = shadertoyBakedDistance(pos);
+			if (!shadertoyConeStep(t, baked > 0.0 ? baked : distf(pos), 0.9 / iResolution.y, 0.004)) break;
+		}
+		shadertoyPrepassResult(t);
+		return vec4(t, 0.0, 0.0, 0.0);
+	}
+	
+	float dist = shadertoyRayStart(0.0);
 	
 	float lastDistEval = 1e10;
 	float edge = 0.0;
 	
-	for(int i = 0; i < maxIter; i++) {
+	// The prepass steps count against the budget, so the image does not change
+	for(int i = min(int(shadertoyRaySteps()), maxIter - 1); i < maxIter; i++) {
 		vec3 pos = (from + increment * dist);
-		float distEval = distf(pos);
+		// Far from surfaces the baked volume is a cheaper (slightly short) step
+		float baked = shadertoyBakedDistance(pos);
+		float distEval = baked > 0.0 ? baked : distf(pos);
 		
 		if (lastDistEval < EDGE_WIDTH && distEval > lastDistEval + 0.001) {
 			edge = 1.0;
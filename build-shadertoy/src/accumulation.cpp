@@ -0,0 +1,68 @@
+#include "../include/accumulation.h"
+#include "../include/trace.h"
+
+// Radical inverse of index in the given base, in [0, 1)
+static float halton(int index, int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    while (index > 0) {
+        result += (index % base) * fraction;
+        index /= base;
+        fraction /= base;
+    }
+    return result;
+}
+
+ProgressiveAccumulator::ProgressiveAccumulator()
+    : enabled(false), maxSamples(64), sampleCount(0), jitterX(0.0f), jitterY(0.0f) {
+}
+
+void ProgressiveAccumulator::setEnabled(bool value) {
+    enabled = value;
+    sampleCount = 0;
+}
+
+bool ProgressiveAccumulator::begin(const AccumulationInputs& inputs) {
+    if (!(inputs == lastInputs)) {
+        lastInputs = inputs;
+        sampleCount = 0;
+    }
+    if (sampleCount >= maxSamples) {
+        return false;
+    }
+    // 32-bit float, so hundreds of samples still average without banding
+    if (!history.resize(inputs.width, inputs.height, GL_RGBA32F)) {
+        return false;
+    }
+    TRACE_SCOPE("accumulate");
+    history.bind();
+    if (sampleCount == 0) {
+        jitterX = 0.0f;
+        jitterY = 0.0f;
+        glDisable(GL_BLEND);
+    } else {
+        // Index 1 of the sequence, (1/2, 1/3), repeats the first sample's x, so it is skipped
+        jitterX = halton(sampleCount + 1, 2) - 0.5f;
+        jitterY = halton(sampleCount + 1, 3) - 0.5f;
+        // history = sample / (n + 1) + history * n / (n + 1)
+        float weight = 1.0f / (sampleCount + 1);
+        glEnable(GL_BLEND);
+        glBlendColor(0.0f, 0.0f, 0.0f, weight);
+        glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+    }
+    return true;
+}
+
+void ProgressiveAccumulator::end() {
+    glDisable(GL_BLEND);
+    sampleCount++;
+}
+
+void ProgressiveAccumulator::blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer) const {
+    history.blitToScreen(windowWidth, windowHeight, screenFramebuffer);
+}
+
+void ProgressiveAccumulator::release() {
+    history.release();
+    sampleCount = 0;
+}
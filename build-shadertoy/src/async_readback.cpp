@@ -0,0 +1,193 @@
+#include "../include/async_readback.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstring>
+
+AsyncReadback::AsyncReadback()
+    : oldest(0), count(0), supported(true), stallMs(0.0f), maxQueued(8), busy(0), stopping(false) {
+    for (int i = 0; i < READBACK_RING_SIZE; i++) {
+        slots[i] = Slot{0, 0, 0, 0, 0, 0, std::string()};
+    }
+}
+
+AsyncReadback::~AsyncReadback() {
+    finish();
+    for (int i = 0; i < READBACK_RING_SIZE; i++) {
+        if (slots[i].pbo != 0) {
+            glDeleteBuffers(1, &slots[i].pbo);
+        }
+    }
+}
+
+void AsyncReadback::start(Consumer frameConsumer, size_t maxQueuedFrames) {
+    if (worker.joinable()) {
+        return;
+    }
+    consumer = frameConsumer;
+    maxQueued = std::max<size_t>(1, maxQueuedFrames);
+    stopping = false;
+    worker = std::thread(&AsyncReadback::consumerLoop, this);
+}
+
+bool AsyncReadback::request(GLuint framebuffer, int width, int height, uint64_t frameIndex, const std::string& tag) {
+    TRACE_SCOPE("readback request");
+    // The oldest readback has had READBACK_RING_SIZE frames to finish; wait for it if not
+    if (count == READBACK_RING_SIZE) {
+        completeOldest();
+    }
+    Slot& slot = slots[(oldest + count) % READBACK_RING_SIZE];
+    size_t size = static_cast<size_t>(width) * height * 4;
+    if (slot.pbo == 0) {
+        glGenBuffers(1, &slot.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (slot.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = supported ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : 0;
+    if (!slot.fence && supported) {
+        std::cerr << "Fence sync not available, readbacks complete synchronously" << std::endl;
+        supported = false;
+    }
+    slot.width = width;
+    slot.height = height;
+    slot.frameIndex = frameIndex;
+    slot.tag = tag;
+    count++;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy++;
+    }
+    return true;
+}
+
+void AsyncReadback::poll(bool wait) {
+    while (count > 0) {
+        Slot& slot = slots[oldest];
+        if (!wait && slot.fence) {
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                // Make sure the fence reaches the GPU, then check again next frame
+                glFlush();
+                return;
+            }
+        }
+        completeOldest();
+    }
+}
+
+void AsyncReadback::completeOldest() {
+    Slot& slot = slots[oldest];
+    if (slot.fence) {
+        uint64_t start = traceNowNs();
+        GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 s
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(slot.fence, 0, 1000000000);
+        }
+        stallMs += (traceNowNs() - start) / 1e6f;
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+    }
+
+    // Copy the rows out of the PBO; flipping happens on the consumer thread
+    ReadbackFrame frame;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.frameIndex = slot.frameIndex;
+    frame.tag = slot.tag;
+    size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+    frame.pixels.resize(size);
+    {
+        TRACE_SCOPE("readback map");
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if (mapped) {
+            std::memcpy(frame.pixels.data(), mapped, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            std::cerr << "ERROR::READBACK::MAP_FAILED" << std::endl;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    oldest = (oldest + 1) % READBACK_RING_SIZE;
+    count--;
+    enqueue(std::move(frame));
+}
+
+void AsyncReadback::enqueue(ReadbackFrame&& frame) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable()) {
+        busy--;
+        return;
+    }
+    if (queue.size() >= maxQueued) {
+        // The consumer is behind (slow disk): wait rather than drop a frame
+        TRACE_SCOPE("readback queue full");
+        uint64_t start = traceNowNs();
+        queueChanged.wait(lock, [this] { return queue.size() < maxQueued; });
+        stallMs += (traceNowNs() - start) / 1e6f;
+    }
+    queue.push_back(std::move(frame));
+    queueChanged.notify_all();
+}
+
+void AsyncReadback::consumerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        ReadbackFrame frame = std::move(queue.front());
+        queue.pop_front();
+        queueChanged.notify_all();
+        lock.unlock();
+
+        {
+            TRACE_SCOPE("readback consume");
+            // GL returns the bottom row first
+            size_t rowBytes = static_cast<size_t>(frame.width) * 4;
+            std::vector<unsigned char> row(rowBytes);
+            for (int y = 0; y < frame.height / 2; y++) {
+                unsigned char* top = frame.pixels.data() + y * rowBytes;
+                unsigned char* bottom = frame.pixels.data() + (frame.height - 1 - y) * rowBytes;
+                std::memcpy(row.data(), top, rowBytes);
+                std::memcpy(top, bottom, rowBytes);
+                std::memcpy(bottom, row.data(), rowBytes);
+            }
+            if (consumer) {
+                consumer(frame);
+            }
+        }
+
+        lock.lock();
+        busy--;
+        queueChanged.notify_all();
+    }
+}
+
+void AsyncReadback::finish() {
+    poll(true);
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [this] { return busy == 0; });
+        stopping = true;
+        queueChanged.notify_all();
+    }
+    worker.join();
+}
+
+int AsyncReadback::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return busy;
+}
@@ -0,0 +1,355 @@
+#include "../include/backend.h"
+#include "../include/trace.h"
+#include <mutex>
+
+#ifdef SHADERTOY_WITH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef SHADERTOY_WITH_OSMESA
+// glew.h undefines GLAPI and APIENTRY, which osmesa.h expects
+#ifndef GLAPI
+#define GLAPI extern
+#endif
+#ifndef APIENTRY
+#define APIENTRY GLAPIENTRY
+#endif
+#include "../../GL/osmesa.h"
+#endif
+
+bool parseBackendType(const std::string& name, BackendType& type) {
+    if (name == "window") {
+        type = BACKEND_WINDOW;
+    } else if (name == "egl") {
+        type = BACKEND_EGL;
+    } else if (name == "osmesa") {
+        type = BACKEND_OSMESA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* getBackendName(BackendType type) {
+    switch (type) {
+        case BACKEND_WINDOW: return "window";
+        case BACKEND_EGL: return "egl";
+        case BACKEND_OSMESA: return "osmesa";
+        default: return "unknown";
+    }
+}
+
+// Function to initialize GLEW for the current context
+static bool initGlew(bool headless) {
+    glewExperimental = GL_TRUE;
+    GLenum glewError = glewInit();
+    // A GLEW built for GLX reports a missing X display on headless contexts. The
+    // core entry points are loaded before that check, so the context is usable.
+    if (glewError == GLEW_ERROR_NO_GLX_DISPLAY && headless) {
+        glewError = GLEW_OK;
+    }
+    if (glewError != GLEW_OK) {
+        std::cerr << "GLEW could not be initialized! Error: " << glewGetErrorString(glewError) << std::endl;
+        return false;
+    }
+    // glewInit may leave an error behind on core profiles
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// SDL window
+//----------------------------------------------------------------------
+class WindowBackend : public RenderBackend {
+public:
+    WindowBackend() : window(nullptr), glContext(nullptr) {}
+
+    ~WindowBackend() override {
+        if (glContext) {
+            SDL_GL_DeleteContext(glContext);
+        }
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+    }
+
+    bool init(const char* title, int width, int height) override {
+        // Initialize SDL
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        // Set OpenGL attributes
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+
+        // Create window with resizable flag
+        window = SDL_CreateWindow(
+            title,
+            SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+            width, height,
+            SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+        );
+        if (!window) {
+            std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        // Create OpenGL context
+        glContext = SDL_GL_CreateContext(window);
+        if (!glContext) {
+            std::cerr << "OpenGL context could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        return initGlew(false);
+    }
+
+    bool makeCurrent() override { return SDL_GL_MakeCurrent(window, glContext) == 0; }
+    void releaseCurrent() override { SDL_GL_MakeCurrent(window, nullptr); }
+    GLuint getFramebuffer() const override { return 0; }
+    void resize(int, int) override {}
+
+    void present() override {
+        TRACE_SCOPE("SDL_GL_SwapWindow");
+        SDL_GL_SwapWindow(window);
+    }
+
+    bool isHeadless() const override { return false; }
+    BackendType getType() const override { return BACKEND_WINDOW; }
+
+private:
+    SDL_Window* window;
+    SDL_GLContext glContext;
+};
+
+//----------------------------------------------------------------------
+// Offscreen: the "screen" is an FBO owned by the backend
+//----------------------------------------------------------------------
+class OffscreenBackend : public RenderBackend {
+public:
+    GLuint getFramebuffer() const override { return screen.getFramebuffer(); }
+
+    void resize(int width, int height) override {
+        screen.resize(width, height);
+    }
+
+    void present() override {
+        TRACE_SCOPE("present");
+        glFlush();
+    }
+
+    bool isHeadless() const override { return true; }
+
+protected:
+    RenderTarget screen;
+
+    // Called by the subclasses once their context is current
+    bool initScreen(int width, int height) {
+        // SDL is only used for timers without a window
+        SDL_Init(SDL_INIT_TIMER);
+        if (!initGlew(true)) {
+            return false;
+        }
+        std::cout << "Offscreen " << getBackendName(getType()) << " context: "
+                  << glGetString(GL_RENDERER) << " / " << glGetString(GL_VERSION) << std::endl;
+        return screen.resize(width, height);
+    }
+};
+
+#ifdef SHADERTOY_WITH_EGL
+// All EGL backends share one display; it is terminated with the last backend
+static std::mutex eglDisplayMutex;
+static EGLDisplay eglSharedDisplay = EGL_NO_DISPLAY;
+static int eglDisplayUsers = 0;
+
+class EglBackend : public OffscreenBackend {
+public:
+    EglBackend() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT) {}
+
+    ~EglBackend() override {
+        if (context != EGL_NO_CONTEXT) {
+            makeCurrent();
+            screen.release();
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY) {
+            std::lock_guard<std::mutex> lock(eglDisplayMutex);
+            if (--eglDisplayUsers == 0) {
+                eglTerminate(eglSharedDisplay);
+                eglSharedDisplay = EGL_NO_DISPLAY;
+            }
+        }
+    }
+
+    bool init(const char*, int width, int height) override {
+        {
+            std::lock_guard<std::mutex> lock(eglDisplayMutex);
+            if (eglSharedDisplay == EGL_NO_DISPLAY) {
+                // Prefer the surfaceless platform: no window system, no GPU required
+                PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+                if (getPlatformDisplay) {
+                    eglSharedDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                }
+                if (eglSharedDisplay == EGL_NO_DISPLAY) {
+                    eglSharedDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+                }
+                EGLint major = 0, minor = 0;
+                if (eglSharedDisplay == EGL_NO_DISPLAY || !eglInitialize(eglSharedDisplay, &major, &minor)) {
+                    std::cerr << "EGL display could not be initialized! EGL error: 0x" << std::hex << eglGetError()
+                              << std::dec << std::endl;
+                    eglSharedDisplay = EGL_NO_DISPLAY;
+                    return false;
+                }
+            }
+            display = eglSharedDisplay;
+            eglDisplayUsers++;
+        }
+
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            std::cerr << "EGL has no desktop OpenGL support" << std::endl;
+            return false;
+        }
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        // No config and no surface: everything is rendered into our FBO
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            std::cerr << "EGL context could not be created! EGL error: 0x" << std::hex << eglGetError()
+                      << std::dec << std::endl;
+            return false;
+        }
+        if (!makeCurrent()) {
+            std::cerr << "EGL context could not be made current (surfaceless contexts unsupported?)" << std::endl;
+            return false;
+        }
+        return initScreen(width, height);
+    }
+
+    bool makeCurrent() override {
+        return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+    }
+
+    void releaseCurrent() override {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+    BackendType getType() const override { return BACKEND_EGL; }
+
+private:
+    EGLDisplay display;
+    EGLContext context;
+};
+#endif // SHADERTOY_WITH_EGL
+
+#ifdef SHADERTOY_WITH_OSMESA
+// Needs a GLEW built for OSMesa (GLEW_OSMESA) so entry points resolve through OSMesaGetProcAddress
+class OsMesaBackend : public OffscreenBackend {
+public:
+    OsMesaBackend() : context(nullptr) {
+        dummyPixel[0] = dummyPixel[1] = dummyPixel[2] = dummyPixel[3] = 0;
+    }
+
+    ~OsMesaBackend() override {
+        if (context) {
+            makeCurrent();
+            screen.release();
+            OSMesaDestroyContext(context);
+        }
+    }
+
+    bool init(const char*, int width, int height) override {
+        const int attributes[] = {
+            OSMESA_FORMAT, OSMESA_RGBA,
+            OSMESA_DEPTH_BITS, 0,
+            OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+            OSMESA_CONTEXT_MAJOR_VERSION, 3,
+            OSMESA_CONTEXT_MINOR_VERSION, 3,
+            0
+        };
+        context = OSMesaCreateContextAttribs(attributes, nullptr);
+        if (!context) {
+            std::cerr << "OSMesa context could not be created (needs Mesa with OpenGL 3.3 core)" << std::endl;
+            return false;
+        }
+        if (!makeCurrent()) {
+            std::cerr << "OSMesa context could not be made current" << std::endl;
+            return false;
+        }
+        return initScreen(width, height);
+    }
+
+    // The context's own buffer is a single pixel, frames go to the FBO
+    bool makeCurrent() override {
+        return OSMesaMakeCurrent(context, dummyPixel, GL_UNSIGNED_BYTE, 1, 1) == GL_TRUE;
+    }
+
+    void releaseCurrent() override {
+        OSMesaMakeCurrent(nullptr, nullptr, GL_UNSIGNED_BYTE, 0, 0);
+    }
+
+    BackendType getType() const override { return BACKEND_OSMESA; }
+
+private:
+    OSMesaContext context;
+    unsigned char dummyPixel[4];
+};
+#endif // SHADERTOY_WITH_OSMESA
+
+std::unique_ptr<RenderBackend> createRenderBackend(BackendType type) {
+    switch (type) {
+        case BACKEND_WINDOW:
+            return std::unique_ptr<RenderBackend>(new WindowBackend());
+        case BACKEND_EGL:
+#ifdef SHADERTOY_WITH_EGL
+            return std::unique_ptr<RenderBackend>(new EglBackend());
+#else
+            std::cerr << "This build has no EGL backend (build with -DSHADERTOY_WITH_EGL -lEGL)" << std::endl;
+            return nullptr;
+#endif
+        case BACKEND_OSMESA:
+#ifdef SHADERTOY_WITH_OSMESA
+            return std::unique_ptr<RenderBackend>(new OsMesaBackend());
+#else
+            std::cerr << "This build has no OSMesa backend (build with -DSHADERTOY_WITH_OSMESA -lOSMesa)" << std::endl;
+            return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+bool readFramebufferRGBA(GLuint framebuffer, int width, int height, std::vector<unsigned char>& pixels) {
+    pixels.resize(static_cast<size_t>(width) * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "ERROR::READBACK::GL_READ_PIXELS_FAILED" << std::endl;
+        return false;
+    }
+
+    // GL returns the bottom row first
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < height / 2; y++) {
+        unsigned char* top = pixels.data() + y * rowBytes;
+        unsigned char* bottom = pixels.data() + (height - 1 - y) * rowBytes;
+        std::copy(top, top + rowBytes, row.begin());
+        std::copy(bottom, bottom + rowBytes, top);
+        std::copy(row.begin(), row.end(), bottom);
+    }
+    return true;
+}
@@ -0,0 +1,250 @@
+#include "../include/batch_render.h"
+#include "../include/shader_manager.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+FrameRangeQueue::FrameRangeQueue(int frameCount, int chunkFrames)
+    : nextFrame(0), frameCount(frameCount), chunkFrames(chunkFrames) {
+}
+
+bool FrameRangeQueue::pop(FrameRange& range) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (nextFrame >= frameCount) {
+        return false;
+    }
+    range.begin = nextFrame;
+    range.end = std::min(frameCount, nextFrame + chunkFrames);
+    nextFrame = range.end;
+    return true;
+}
+
+FrameReorderBuffer::FrameReorderBuffer(int frameCount, int window)
+    : frameCount(frameCount), window(window), nextIndex(0), aborted(false) {
+}
+
+void FrameReorderBuffer::push(int frameIndex, std::vector<unsigned char>&& pixels) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return aborted || frameIndex < nextIndex + window; });
+    if (aborted) {
+        return;
+    }
+    frames[frameIndex] = std::move(pixels);
+    changed.notify_all();
+}
+
+bool FrameReorderBuffer::popNext(std::vector<unsigned char>& pixels, int& frameIndex) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return aborted || nextIndex >= frameCount || frames.count(nextIndex) != 0; });
+    if (aborted || nextIndex >= frameCount) {
+        return false;
+    }
+    std::map<int, std::vector<unsigned char>>::iterator next = frames.find(nextIndex);
+    pixels = std::move(next->second);
+    frames.erase(next);
+    frameIndex = nextIndex++;
+    changed.notify_all();
+    return true;
+}
+
+void FrameReorderBuffer::abort() {
+    std::lock_guard<std::mutex> lock(mutex);
+    aborted = true;
+    changed.notify_all();
+}
+
+bool FrameReorderBuffer::isAborted() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return aborted;
+}
+
+// What the contexts share: the job, and the program binary of the first compile
+struct BatchJob {
+    const std::string* fragmentSource;
+    const VideoExportSettings* settings;
+    BackendType backend;
+    FrameRangeQueue* queue;
+    FrameReorderBuffer* reorder;
+
+    // Context creation and GLEW setup run one worker at a time
+    std::mutex initMutex;
+    std::vector<unsigned char> programBinary;
+    GLenum programBinaryFormat = 0;
+    bool binaryTried = false;
+};
+
+// Per-worker counters for the report
+struct BatchWorkerStats {
+    int frames = 0;
+    bool restoredBinary = false;
+    double setupMs = 0.0;
+    double busyMs = 0.0;
+    bool failed = false;
+};
+
+static void batchWorker(BatchJob& job, int worker, BatchWorkerStats& stats) {
+    const VideoExportSettings& settings = *job.settings;
+    uint64_t setupStart = traceNowNs();
+    std::unique_ptr<RenderBackend> backend;
+    ShaderManager shader;
+    {
+        TRACE_SCOPE("worker setup");
+        std::lock_guard<std::mutex> lock(job.initMutex);
+        backend = createRenderBackend(job.backend);
+        if (!backend || !backend->init("batch worker", settings.width, settings.height)) {
+            std::cerr << "Worker " << worker << ": failed to create a " << getBackendName(job.backend)
+                      << " context" << std::endl;
+            stats.failed = true;
+            job.reorder->abort();
+            return;
+        }
+        stats.restoredBinary = shader.loadFromBinary(job.programBinary, job.programBinaryFormat);
+        if (!stats.restoredBinary) {
+            if (!shader.loadFromStrings(defaultVertexShader, *job.fragmentSource)) {
+                stats.failed = true;
+                job.reorder->abort();
+                return;
+            }
+            if (!job.binaryTried) {
+                job.binaryTried = true;
+                shader.getProgramBinary(job.programBinary, job.programBinaryFormat);
+            }
+        }
+    }
+    GLuint quadVAO = createFullScreenQuad();
+    stats.setupMs = (traceNowNs() - setupStart) / 1e6;
+
+    uint64_t busyStart = traceNowNs();
+    FrameRange range;
+    while (!job.reorder->isAborted() && job.queue->pop(range)) {
+        for (int frame = range.begin; frame < range.end; frame++) {
+            TRACE_SCOPE("batch frame");
+            glBindFramebuffer(GL_FRAMEBUFFER, backend->getFramebuffer());
+            glViewport(0, 0, settings.width, settings.height);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            // Same deterministic clock as exportVideo
+            shader.setupShaderToyUniforms(settings.width, settings.height, static_cast<float>(frame) / settings.fps,
+                                          1.0f / settings.fps, frame, 0, settings.height, false);
+            glBindVertexArray(quadVAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+            // Each context has its own thread, so a blocking read only holds up this worker
+            std::vector<unsigned char> pixels;
+            readFramebufferRGBA(backend->getFramebuffer(), settings.width, settings.height, pixels);
+            job.reorder->push(frame, std::move(pixels));
+            stats.frames++;
+        }
+    }
+    stats.busyMs = (traceNowNs() - busyStart) / 1e6;
+    glDeleteVertexArrays(1, &quadVAO);
+}
+
+// One run of the whole job; writer may be null (timing only). Returns the frames per second.
+static double runBatch(const std::string& fragmentSource, BackendType backend, const VideoExportSettings& settings,
+                       int workers, VideoWriter* writer, bool& ok) {
+    int frameCount = std::max(1, static_cast<int>(settings.durationSeconds * settings.fps + 0.5f));
+    FrameRangeQueue queue(frameCount, BATCH_CHUNK_FRAMES);
+    // Enough slack that no worker waits on a neighbour's chunk in the normal case
+    FrameReorderBuffer reorder(frameCount, workers * BATCH_CHUNK_FRAMES * 2);
+
+    BatchJob job;
+    job.fragmentSource = &fragmentSource;
+    job.settings = &settings;
+    job.backend = backend;
+    job.queue = &queue;
+    job.reorder = &reorder;
+
+    uint64_t startNs = traceNowNs();
+    std::vector<BatchWorkerStats> stats(workers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back(batchWorker, std::ref(job), i, std::ref(stats[i]));
+    }
+
+    // This thread writes the frames in order as they become available
+    ReadbackFrame frame;
+    frame.width = settings.width;
+    frame.height = settings.height;
+    int frameIndex = 0;
+    int written = 0;
+    uint64_t lastReportNs = startNs;
+    while (reorder.popNext(frame.pixels, frameIndex)) {
+        if (writer) {
+            TRACE_SCOPE("video write");
+            frame.frameIndex = frameIndex;
+            if (!writer->writeFrame(frame)) {
+                reorder.abort();
+                break;
+            }
+        }
+        written++;
+        uint64_t now = traceNowNs();
+        if (writer && now - lastReportNs > 1000000000ull) {
+            lastReportNs = now;
+            std::cerr << "  frame " << written << "/" << frameCount << " ("
+                      << written * 1e9 / (now - startNs) << " fps)" << std::endl;
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = (traceNowNs() - startNs) / 1e9;
+
+    ok = written == frameCount;
+    for (int i = 0; i < workers; i++) {
+        ok = ok && !stats[i].failed;
+        if (writer) {
+            std::cerr << "  worker " << i << ": " << stats[i].frames << " frames, setup "
+                      << stats[i].setupMs << " ms ("
+                      << (stats[i].restoredBinary ? "program binary" : "compiled") << "), busy "
+                      << stats[i].busyMs << " ms" << std::endl;
+        }
+    }
+    return seconds > 0.0 ? written / seconds : 0.0;
+}
+
+static void printScaling(int count, double fps, double singleFps) {
+    std::fprintf(stderr, "  %2d contexts: %8.2f fps  speedup %5.2fx  efficiency %5.1f%%\n",
+                 count, fps, fps / singleFps, 100.0 * fps / (singleFps * count));
+}
+
+bool exportVideoParallel(const std::string& fragmentSource, BackendType backend,
+                         const VideoExportSettings& settings, int workers, bool scalingReport) {
+    workers = std::max(1, workers);
+    // Timing-only runs with fewer contexts; the run with all of them writes the output
+    double singleFps = 0.0;
+    std::vector<std::pair<int, double>> scaling;
+    for (int count = 1; scalingReport && count < workers; count *= 2) {
+        bool ok = false;
+        double fps = runBatch(fragmentSource, backend, settings, count, nullptr, ok);
+        if (!ok) {
+            return false;
+        }
+        singleFps = count == 1 ? fps : singleFps;
+        scaling.push_back(std::make_pair(count, fps));
+    }
+
+    VideoWriter writer;
+    if (!writer.open(settings)) {
+        return false;
+    }
+    std::cerr << "Exporting on " << workers << " contexts to "
+              << (settings.path == "-" ? "stdout" : settings.path) << std::endl;
+    bool ok = false;
+    double fps = runBatch(fragmentSource, backend, settings, workers, &writer, ok);
+    writer.close();
+    std::cerr << "Exported at " << fps << " fps (" << fps / settings.fps << "x real time, "
+              << writer.getBytesWritten() / (1024 * 1024) << " MiB)" << std::endl;
+
+    if (scalingReport && fps > 0.0) {
+        singleFps = workers == 1 ? fps : singleFps;
+        scaling.push_back(std::make_pair(workers, fps));
+        std::cerr << "Scaling versus one context (" << settings.width << "x" << settings.height << "):" << std::endl;
+        for (const std::pair<int, double>& run : scaling) {
+            printScaling(run.first, run.second, singleFps);
+        }
+    }
+    return ok && !writer.hasFailed();
+}
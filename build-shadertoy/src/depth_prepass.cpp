@@ -0,0 +1,55 @@
+#include "../include/depth_prepass.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+bool shaderUsesDepthPrepass(const std::string& shaderToyCode) {
+    return shaderToyCode.find("shadertoyRayStart") != std::string::npos;
+}
+
+DepthPrepass::DepthPrepass() : blockSize(DEFAULT_PREPASS_BLOCK) {
+}
+
+void DepthPrepass::setBlockSize(int value) {
+    // The block centre needs a stride of at least 2 (the wrapper's iInterleave)
+    blockSize = std::max(2, value);
+}
+
+bool DepthPrepass::begin(ShaderManager& shader, GLuint quadVAO, int width, int height) {
+    TRACE_SCOPE("depth prepass");
+    FramebufferScope binding;
+    // Distance and step count per block, 32-bit so far distances keep their precision
+    int blocksX = (width + blockSize - 1) / blockSize;
+    int blocksY = (height + blockSize - 1) / blockSize;
+    if (!depth.resize(blocksX, blocksY, GL_RG32F)) {
+        return false;
+    }
+
+    // One fragment per block, at the block's centre. The distances are written, not
+    // blended: accumulation leaves blending on for the draw that follows
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    depth.bind();
+    float centre = blockSize * 0.5f - 0.5f;
+    shader.setupShaderToyInterleave(static_cast<float>(blockSize), static_cast<float>(blockSize), centre, centre);
+    shader.setupShaderToyPrepass(1, blockSize, PREPASS_TEXTURE_UNIT);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    if (blend) {
+        glEnable(GL_BLEND);
+    }
+
+    shader.setupShaderToyInterleave(0.0f, 0.0f, 0.0f, 0.0f);
+    shader.setupShaderToyPrepass(2, blockSize, PREPASS_TEXTURE_UNIT);
+    glActiveTexture(GL_TEXTURE0 + PREPASS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depth.getTexture());
+    glActiveTexture(GL_TEXTURE0);
+    return true;
+}
+
+void DepthPrepass::end(ShaderManager& shader) {
+    shader.setupShaderToyPrepass(0, blockSize, PREPASS_TEXTURE_UNIT);
+    glActiveTexture(GL_TEXTURE0 + PREPASS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
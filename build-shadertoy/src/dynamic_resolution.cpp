@@ -0,0 +1,64 @@
+#include "../include/dynamic_resolution.h"
+#include "../include/gpu_timer.h"
+#include <algorithm>
+#include <cmath>
+
+// Frames ignored after a scale change: GPU timings arrive a few frames late
+const int DYNAMIC_RESOLUTION_SETTLE_FRAMES = GPU_TIMER_RING_SIZE + 2;
+
+// Weight of the newest frame in the smoothed cost
+const float DYNAMIC_RESOLUTION_SMOOTHING = 0.25f;
+
+DynamicResolution::DynamicResolution() : enabled(false), scale(1.0f), smoothedMs(0.0f), settleFrames(0) {
+}
+
+void DynamicResolution::setConfig(const DynamicResolutionConfig& value) {
+    config = value;
+    config.minScale = std::max(0.05f, std::min(config.minScale, 1.0f));
+    config.maxScale = std::max(config.minScale, std::min(config.maxScale, 1.0f));
+    scale = std::max(config.minScale, std::min(scale, config.maxScale));
+}
+
+void DynamicResolution::setEnabled(bool value) {
+    enabled = value;
+    reset();
+}
+
+void DynamicResolution::reset() {
+    smoothedMs = 0.0f;
+    settleFrames = DYNAMIC_RESOLUTION_SETTLE_FRAMES;
+}
+
+void DynamicResolution::reportFrame(float costMs) {
+    if (!enabled || costMs <= 0.0f) {
+        return;
+    }
+    if (settleFrames > 0) {
+        settleFrames--;
+        return;
+    }
+    smoothedMs = smoothedMs == 0.0f ? costMs
+                                    : smoothedMs + (costMs - smoothedMs) * DYNAMIC_RESOLUTION_SMOOTHING;
+
+    float aimMs = config.targetMs * config.headroom;
+    float ideal = scale * std::sqrt(aimMs / smoothedMs);
+    float newScale = scale;
+    if (smoothedMs > aimMs) {
+        // Too slow: go straight to the predicted scale, rounded down to a step
+        newScale = std::floor(ideal / config.scaleStep) * config.scaleStep;
+        newScale = std::min(newScale, scale - config.scaleStep);
+    } else if (smoothedMs < aimMs * config.raiseFraction) {
+        // Clearly fast enough: one step up, as long as the prediction allows it
+        if (ideal >= scale + config.scaleStep) {
+            newScale = scale + config.scaleStep;
+        }
+    }
+    newScale = std::max(config.minScale, std::min(newScale, config.maxScale));
+    if (std::fabs(newScale - scale) < config.scaleStep * 0.5f) {
+        return;
+    }
+    // Predict the cost at the new scale so the next decision starts from it
+    smoothedMs *= (newScale * newScale) / (scale * scale);
+    scale = newScale;
+    settleFrames = DYNAMIC_RESOLUTION_SETTLE_FRAMES;
+}
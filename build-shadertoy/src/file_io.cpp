@@ -0,0 +1,41 @@
+#include "../include/file_io.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+uint64_t hashSource(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool saveFileAtomically(const std::string& filePath, const char* module, const char* mode,
+                        const std::function<void(std::FILE*)>& write) {
+    std::string temporaryPath = filePath + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), mode);
+    if (!file) {
+        std::cerr << "ERROR::" << module << "::CANNOT_OPEN_FILE: " << temporaryPath << std::endl;
+        return false;
+    }
+    write(file);
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (ok) {
+#ifdef _WIN32
+        // rename() does not replace an existing file on Windows
+        ok = MoveFileExA(temporaryPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        // POSIX rename() replaces the target in one step
+        ok = std::rename(temporaryPath.c_str(), filePath.c_str()) == 0;
+#endif
+    }
+    if (!ok) {
+        std::remove(temporaryPath.c_str());
+        std::cerr << "ERROR::" << module << "::WRITE_FAILED: " << filePath << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,145 @@
+#include "../include/foveated_render.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cmath>
+
+// Resolution of each layer relative to the window, periphery first
+static const int FOVEA_LAYER_DIVISORS[3] = {4, 2, 1};
+
+// Composite pass: one fragment per window pixel
+static const char* compositeFragmentShader = R"(
+    #version 330 core
+    in vec2 fragCoord;
+    out vec4 fragColor;
+
+    uniform sampler2D uPeriphery;   // Whole frame, quarter resolution
+    uniform sampler2D uMiddle;      // uMiddleBox, half resolution
+    uniform sampler2D uFovea;       // uFoveaBox, full resolution
+    uniform vec2 uResolution;
+    uniform vec4 uMiddleBox;        // Pixel offset (xy) and size (zw) in the frame
+    uniform vec4 uFoveaBox;
+    uniform vec2 uFocus;            // Pixels from the bottom-left
+    uniform float uRadius;
+    uniform float uFalloff;
+
+    void main() {
+        vec2 p = gl_FragCoord.xy;
+        float d = distance(p, uFocus);
+        vec4 color = texture(uPeriphery, p / uResolution);
+        float middle = 1.0 - smoothstep(uRadius + uFalloff, uRadius + 2.0 * uFalloff, d);
+        if (middle > 0.0 && uMiddleBox.z > 0.0) {
+            color = mix(color, texture(uMiddle, (p - uMiddleBox.xy) / uMiddleBox.zw), middle);
+        }
+        float fovea = 1.0 - smoothstep(uRadius, uRadius + uFalloff, d);
+        if (fovea > 0.0 && uFoveaBox.z > 0.0) {
+            color = mix(color, texture(uFovea, (p - uFoveaBox.xy) / uFoveaBox.zw), fovea);
+        }
+        fragColor = color;
+    }
+)";
+
+FoveatedRenderer::FoveatedRenderer()
+    : enabled(false), lastSavedFraction(0.0f), shadedFragments(0), fullFragments(0) {
+}
+
+bool FoveatedRenderer::init() {
+    if (!composite.loadFromStrings(defaultVertexShader, compositeFragmentShader)) {
+        std::cerr << "Failed to compile the foveation composite shader!" << std::endl;
+        return false;
+    }
+    composite.use();
+    composite.setInt("uPeriphery", 0);
+    composite.setInt("uMiddle", 1);
+    composite.setInt("uFovea", 2);
+    glUseProgram(0);
+    return true;
+}
+
+void FoveatedRenderer::setConfig(const FoveationConfig& value) {
+    config = value;
+    config.radius = std::max(0.0f, config.radius);
+    // smoothstep needs distinct edges
+    config.falloff = std::max(1.0f, config.falloff);
+}
+
+bool FoveatedRenderer::render(ShaderManager& shader, GLuint quadVAO, int width, int height, int focusX, int focusY,
+                              GLuint screenFramebuffer) {
+    if (composite.getProgramID() == 0) {
+        return false;
+    }
+    TRACE_SCOPE("foveated draw");
+    float centerX = static_cast<float>(focusX);
+    float centerY = static_cast<float>(height - focusY);
+
+    // Boxes around the focus, clipped to the frame; the periphery is the whole frame
+    int boxes[3][4] = {{0, 0, width, height}};
+    float reach[3] = {0.0f, config.radius + 2.0f * config.falloff, config.radius + config.falloff};
+    for (int layer = 1; layer < 3; layer++) {
+        int x0 = std::max(0, static_cast<int>(std::floor(centerX - reach[layer])));
+        int y0 = std::max(0, static_cast<int>(std::floor(centerY - reach[layer])));
+        int x1 = std::min(width, static_cast<int>(std::ceil(centerX + reach[layer])));
+        int y1 = std::min(height, static_cast<int>(std::ceil(centerY + reach[layer])));
+        boxes[layer][0] = x0;
+        boxes[layer][1] = y0;
+        boxes[layer][2] = std::max(0, x1 - x0);
+        boxes[layer][3] = std::max(0, y1 - y0);
+    }
+
+    uint64_t shaded = 0;
+    glBindVertexArray(quadVAO);
+    for (int layer = 0; layer < 3; layer++) {
+        int* box = boxes[layer];
+        if (box[2] == 0 || box[3] == 0) {
+            continue;
+        }
+        int divisor = FOVEA_LAYER_DIVISORS[layer];
+        int layerWidth = std::max(1, (box[2] + divisor - 1) / divisor);
+        int layerHeight = std::max(1, (box[3] + divisor - 1) / divisor);
+        if (!layers[layer].resize(layerWidth, layerHeight)) {
+            glBindVertexArray(0);
+            return false;
+        }
+        layers[layer].bind();
+        shader.setupShaderToyTile(box[0], box[1], box[2], box[3]);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        shaded += static_cast<uint64_t>(layerWidth) * layerHeight;
+    }
+    glBindVertexArray(0);
+    shader.setupShaderToyTile(0, 0, 0, 0);
+
+    uint64_t full = static_cast<uint64_t>(width) * height;
+    lastSavedFraction = full > shaded ? static_cast<float>(full - shaded) / full : 0.0f;
+    shadedFragments += shaded;
+    fullFragments += full;
+
+    // Composite into the screen
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glViewport(0, 0, width, height);
+    composite.use();
+    composite.setVec2("uResolution", static_cast<float>(width), static_cast<float>(height));
+    composite.setVec4("uMiddleBox", static_cast<float>(boxes[1][0]), static_cast<float>(boxes[1][1]),
+                      static_cast<float>(boxes[1][2]), static_cast<float>(boxes[1][3]));
+    composite.setVec4("uFoveaBox", static_cast<float>(boxes[2][0]), static_cast<float>(boxes[2][1]),
+                      static_cast<float>(boxes[2][2]), static_cast<float>(boxes[2][3]));
+    composite.setVec2("uFocus", centerX, centerY);
+    composite.setFloat("uRadius", config.radius);
+    composite.setFloat("uFalloff", config.falloff);
+    for (int layer = 0; layer < 3; layer++) {
+        glActiveTexture(GL_TEXTURE0 + layer);
+        glBindTexture(GL_TEXTURE_2D, layers[layer].getTexture());
+    }
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    for (int layer = 2; layer >= 0; layer--) {
+        glActiveTexture(GL_TEXTURE0 + layer);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    return true;
+}
+
+void FoveatedRenderer::release() {
+    for (RenderTarget& layer : layers) {
+        layer.release();
+    }
+}
@@ -0,0 +1,63 @@
+#include "../include/frame_pacer.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+FramePacer::FramePacer() : oldest(0), count(0), maxFramesInFlight(2), supported(true) {
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT_LIMIT; i++) {
+        fences[i] = 0;
+    }
+}
+
+FramePacer::~FramePacer() {
+    for (int i = 0; i < count; i++) {
+        glDeleteSync(fences[(oldest + i) % MAX_FRAMES_IN_FLIGHT_LIMIT]);
+    }
+}
+
+void FramePacer::setMaxFramesInFlight(int value) {
+    maxFramesInFlight = std::max(1, std::min(MAX_FRAMES_IN_FLIGHT_LIMIT, value));
+}
+
+float FramePacer::waitForFrameSlot() {
+    if (count < maxFramesInFlight) {
+        return 0.0f;
+    }
+    TRACE_SCOPE("frame pacing wait");
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (count >= maxFramesInFlight) {
+        GLsync fence = fences[oldest];
+        // Flush on the first wait so the fence is guaranteed to signal eventually
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, 0, 100000000);
+        }
+        if (result == GL_WAIT_FAILED) {
+            std::cerr << "ERROR::FRAME_PACER::WAIT_FAILED" << std::endl;
+        }
+        glDeleteSync(fence);
+        fences[oldest] = 0;
+        oldest = (oldest + 1) % MAX_FRAMES_IN_FLIGHT_LIMIT;
+        count--;
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+void FramePacer::onFrameSubmitted() {
+    if (!supported) {
+        return;
+    }
+    // The ring can only be full if waitForFrameSlot was skipped; drop the oldest
+    if (count == MAX_FRAMES_IN_FLIGHT_LIMIT) {
+        glDeleteSync(fences[oldest]);
+        oldest = (oldest + 1) % MAX_FRAMES_IN_FLIGHT_LIMIT;
+        count--;
+    }
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!fence) {
+        std::cerr << "Fence sync not available, frames in flight are not limited" << std::endl;
+        supported = false;
+        return;
+    }
+    fences[(oldest + count) % MAX_FRAMES_IN_FLIGHT_LIMIT] = fence;
+    count++;
+}
@@ -0,0 +1,44 @@
+#include "../include/frame_stats.h"
+#include <algorithm>
+
+FrameStats::FrameStats() : next(0), count(0) {
+    for (int i = 0; i < FRAME_STATS_HISTORY; i++) {
+        samples[i] = FrameSample{0.0f, 0.0f, -1.0f, 0.0f};
+    }
+}
+
+void FrameStats::addFrame(float frameMs, float cpuMs, float gpuMs, float waitMs) {
+    samples[next] = FrameSample{frameMs, cpuMs, gpuMs, waitMs};
+    next = (next + 1) % FRAME_STATS_HISTORY;
+    count = std::min(count + 1, FRAME_STATS_HISTORY);
+}
+
+float FrameStats::getFrameMsPercentile(float percentile) const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float sorted[FRAME_STATS_HISTORY];
+    for (int i = 0; i < count; i++) {
+        sorted[i] = getSample(i).frameMs;
+    }
+    int index = static_cast<int>(percentile / 100.0f * (count - 1) + 0.5f);
+    index = std::max(0, std::min(count - 1, index));
+    std::nth_element(sorted, sorted + index, sorted + count);
+    return sorted[index];
+}
+
+float FrameStats::getAverageFps() const {
+    float totalMs = 0.0f;
+    for (int i = 0; i < count; i++) {
+        totalMs += getSample(i).frameMs;
+    }
+    return totalMs > 0.0f ? count * 1000.0f / totalMs : 0.0f;
+}
+
+const FrameSample& FrameStats::getSample(int age) const {
+    int index = (next - 1 - age) % FRAME_STATS_HISTORY;
+    if (index < 0) {
+        index += FRAME_STATS_HISTORY;
+    }
+    return samples[index];
+}
@@ -0,0 +1,92 @@
+#include "../include/gpu_timer.h"
+#include "../include/trace.h"
+
+// Re-measure the GPU/CPU clock offset this often to follow clock drift
+const uint64_t GPU_TIMER_CALIBRATION_INTERVAL_NS = 1000000000ull;
+
+GpuTimer::GpuTimer(const char* name)
+    : name(name), supported(false), writeSlot(0), open(false), lastMs(-1.0f),
+      gpuToTraceOffsetNs(0), lastCalibrationNs(0) {
+    for (int i = 0; i < GPU_TIMER_RING_SIZE; i++) {
+        queries[i][0] = queries[i][1] = 0;
+        pending[i] = false;
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    if (supported) {
+        glDeleteQueries(GPU_TIMER_RING_SIZE * 2, &queries[0][0]);
+    }
+}
+
+bool GpuTimer::init() {
+    // Timestamp queries are core since OpenGL 3.3
+    supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (!supported) {
+        std::cout << "GPU timer queries not supported, GPU zones disabled" << std::endl;
+        return false;
+    }
+    glGenQueries(GPU_TIMER_RING_SIZE * 2, &queries[0][0]);
+    calibrate();
+    return true;
+}
+
+void GpuTimer::calibrate() {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    uint64_t cpuNow = traceNowNs();
+    gpuToTraceOffsetNs = static_cast<int64_t>(cpuNow) - static_cast<int64_t>(gpuNow);
+    lastCalibrationNs = cpuNow;
+}
+
+void GpuTimer::begin() {
+    if (!supported || open) {
+        return;
+    }
+    // Ring is full of unresolved queries - skip this frame rather than block
+    if (pending[writeSlot]) {
+        return;
+    }
+    glQueryCounter(queries[writeSlot][0], GL_TIMESTAMP);
+    open = true;
+}
+
+void GpuTimer::end() {
+    if (!supported || !open) {
+        return;
+    }
+    glQueryCounter(queries[writeSlot][1], GL_TIMESTAMP);
+    pending[writeSlot] = true;
+    writeSlot = (writeSlot + 1) % GPU_TIMER_RING_SIZE;
+    open = false;
+}
+
+void GpuTimer::resolve() {
+    if (!supported) {
+        return;
+    }
+    // Walk from the oldest slot so results come out in submission order
+    for (int i = 0; i < GPU_TIMER_RING_SIZE; i++) {
+        int slot = (writeSlot + i) % GPU_TIMER_RING_SIZE;
+        if (!pending[slot]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 startTicks = 0, endTicks = 0;
+        glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &startTicks);
+        glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &endTicks);
+        pending[slot] = false;
+
+        uint64_t durationNs = endTicks > startTicks ? endTicks - startTicks : 0;
+        lastMs = durationNs / 1000000.0f;
+        traceRecordGpu(name, static_cast<uint64_t>(static_cast<int64_t>(startTicks) + gpuToTraceOffsetNs), durationNs);
+    }
+
+    if (traceNowNs() - lastCalibrationNs > GPU_TIMER_CALIBRATION_INTERVAL_NS) {
+        calibrate();
+    }
+}
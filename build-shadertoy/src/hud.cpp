@@ -0,0 +1,353 @@
+#include "../include/hud.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstdio>
+
+// Font atlas layout: ASCII 32..127 in a 16x6 grid of 6x8 cells (5x7 glyph + padding)
+const int HUD_GLYPH_WIDTH = 5;
+const int HUD_GLYPH_HEIGHT = 7;
+const int HUD_CELL_WIDTH = 6;
+const int HUD_CELL_HEIGHT = 8;
+const int HUD_ATLAS_COLUMNS = 16;
+const int HUD_ATLAS_ROWS = 6;
+const int HUD_ATLAS_WIDTH = HUD_ATLAS_COLUMNS * HUD_CELL_WIDTH;
+const int HUD_ATLAS_HEIGHT = HUD_ATLAS_ROWS * HUD_CELL_HEIGHT;
+
+// On-screen size of one font pixel
+const float HUD_TEXT_SCALE = 2.0f;
+
+// Frames shown in the graph and the frame time that fills its full height
+const int HUD_GRAPH_FRAMES = 120;
+const float HUD_GRAPH_MAX_MS = 50.0f;
+
+// 5x7 glyphs for ASCII 32..127, one byte per row, bit 4 = leftmost pixel.
+// Lower case letters reuse the upper case shapes; 127 is a solid block used for panels.
+static const unsigned char HUD_FONT[96][HUD_GLYPH_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, // '!'
+    {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}, // '#'
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}, // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, // '%'
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D}, // '&'
+    {0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}, // '''
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, // ')'
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}, // '*'
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}, // ','
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // '/'
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // '0'
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // '1'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // '2'
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // '3'
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // '4'
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // '5'
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // '6'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // '7'
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // '8'
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}, // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, // '<'
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}, // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, // '>'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}, // '?'
+    {0x0E, 0x11, 0x17, 0x15, 0x17, 0x10, 0x0E}, // '@'
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'A'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // 'B'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // 'C'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // 'D'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // 'E'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // 'F'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // 'G'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'H'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // 'L'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // 'N'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'O'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // 'P'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // 'Q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // 'R'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // 'S'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // 'W'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // 'X'
+    {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}, // 'Y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // 'Z'
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}, // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, // backslash
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}, // ']'
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, // '_'
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'a'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // 'b'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // 'c'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // 'd'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // 'e'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // 'f'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // 'g'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'h'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 'i'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'j'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // 'k'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // 'l'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // 'm'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // 'n'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'o'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // 'p'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // 'q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // 'r'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // 's'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // 't'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'u'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // 'v'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // 'w'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // 'x'
+    {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}, // 'y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // 'z'
+    {0x03, 0x04, 0x04, 0x08, 0x04, 0x04, 0x03}, // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // '|'
+    {0x18, 0x04, 0x04, 0x02, 0x04, 0x04, 0x18}, // '}'
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00}, // '~'
+    {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, // solid
+};
+
+// Overlay shaders - positions are in window pixels, origin at the top left
+static const char* hudVertexShader = R"(
+    #version 330 core
+    layout (location = 0) in vec2 position;
+    layout (location = 1) in vec2 texCoord;
+    layout (location = 2) in vec4 color;
+
+    uniform vec2 uScreen;
+
+    out vec2 uv;
+    out vec4 tint;
+
+    void main()
+    {
+        gl_Position = vec4(position.x / uScreen.x * 2.0 - 1.0, 1.0 - position.y / uScreen.y * 2.0, 0.0, 1.0);
+        uv = texCoord;
+        tint = color;
+    }
+)";
+
+static const char* hudFragmentShader = R"(
+    #version 330 core
+    in vec2 uv;
+    in vec4 tint;
+    out vec4 fragColor;
+
+    uniform sampler2D uAtlas;
+
+    void main()
+    {
+        fragColor = vec4(tint.rgb, tint.a * texture(uAtlas, uv).r);
+    }
+)";
+
+Hud::Hud()
+    : visible(false), programID(0), atlasTexture(0), vao(0), vbo(0), screenLoc(-1), vboCapacity(0) {
+}
+
+Hud::~Hud() {
+    if (vbo != 0) {
+        glDeleteBuffers(1, &vbo);
+    }
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+    }
+    if (atlasTexture != 0) {
+        glDeleteTextures(1, &atlasTexture);
+    }
+}
+
+bool Hud::init() {
+    if (!shader.loadFromStrings(hudVertexShader, hudFragmentShader)) {
+        std::cerr << "Failed to compile HUD shader!" << std::endl;
+        return false;
+    }
+    programID = shader.getProgramID();
+    screenLoc = glGetUniformLocation(programID, "uScreen");
+    glUseProgram(programID);
+    glUniform1i(glGetUniformLocation(programID, "uAtlas"), 0);
+    glUseProgram(0);
+
+    // Bake the glyph bitmaps into a single-channel atlas
+    std::vector<unsigned char> atlas(HUD_ATLAS_WIDTH * HUD_ATLAS_HEIGHT, 0);
+    for (int glyph = 0; glyph < 96; glyph++) {
+        int cellX = (glyph % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH;
+        int cellY = (glyph / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT;
+        for (int row = 0; row < HUD_GLYPH_HEIGHT; row++) {
+            for (int col = 0; col < HUD_GLYPH_WIDTH; col++) {
+                if (HUD_FONT[glyph][row] & (0x10 >> col)) {
+                    atlas[(cellY + row) * HUD_ATLAS_WIDTH + cellX + col] = 255;
+                }
+            }
+        }
+    }
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, HUD_ATLAS_WIDTH, HUD_ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Dynamic vertex buffer, refilled every frame
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    vertices.reserve(2048);
+    return true;
+}
+
+void Hud::addQuad(float x, float y, float w, float h, float u0, float v0, float u1, float v1,
+                  float r, float g, float b, float a) {
+    Vertex topLeft = {x, y, u0, v0, r, g, b, a};
+    Vertex topRight = {x + w, y, u1, v0, r, g, b, a};
+    Vertex bottomRight = {x + w, y + h, u1, v1, r, g, b, a};
+    Vertex bottomLeft = {x, y + h, u0, v1, r, g, b, a};
+    vertices.push_back(topLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomRight);
+    vertices.push_back(topLeft);
+    vertices.push_back(bottomRight);
+    vertices.push_back(bottomLeft);
+}
+
+void Hud::addRect(float x, float y, float w, float h, float r, float g, float b, float a) {
+    // Sample the middle of the solid glyph so the quad is fully covered
+    int glyph = 127 - 32;
+    float u = ((glyph % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH + 2.5f) / HUD_ATLAS_WIDTH;
+    float v = ((glyph / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT + 3.5f) / HUD_ATLAS_HEIGHT;
+    addQuad(x, y, w, h, u, v, u, v, r, g, b, a);
+}
+
+void Hud::addText(const std::string& text, float x, float y, float r, float g, float b) {
+    float glyphW = HUD_GLYPH_WIDTH * HUD_TEXT_SCALE;
+    float glyphH = HUD_GLYPH_HEIGHT * HUD_TEXT_SCALE;
+    float advance = HUD_CELL_WIDTH * HUD_TEXT_SCALE;
+    for (char c : text) {
+        int glyph = (c >= 32 && c < 127) ? c - 32 : '?' - 32;
+        if (glyph != 0) {
+            float u0 = static_cast<float>((glyph % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH) / HUD_ATLAS_WIDTH;
+            float v0 = static_cast<float>((glyph / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT) / HUD_ATLAS_HEIGHT;
+            float u1 = u0 + static_cast<float>(HUD_GLYPH_WIDTH) / HUD_ATLAS_WIDTH;
+            float v1 = v0 + static_cast<float>(HUD_GLYPH_HEIGHT) / HUD_ATLAS_HEIGHT;
+            addQuad(x, y, glyphW, glyphH, u0, v0, u1, v1, r, g, b, 1.0f);
+        }
+        x += advance;
+    }
+}
+
+void Hud::draw(const FrameStats& stats, const std::string& shaderName, int windowWidth, int windowHeight) {
+    if (!visible || programID == 0) {
+        return;
+    }
+    TRACE_SCOPE("hud");
+
+    // Text readouts
+    const FrameSample& latest = stats.getSample(0);
+    char line[128];
+    std::string lines[3];
+    lines[0] = shaderName;
+    std::snprintf(line, sizeof(line), "FPS %5.1f P50 %4.1f P95 %4.1f P99 %4.1f",
+                  stats.getAverageFps(), stats.getFrameMsPercentile(50.0f),
+                  stats.getFrameMsPercentile(95.0f), stats.getFrameMsPercentile(99.0f));
+    lines[1] = line;
+    if (latest.gpuMs >= 0.0f) {
+        std::snprintf(line, sizeof(line), "CPU %5.2f GPU %5.2f WAIT %5.2f MS", latest.cpuMs, latest.gpuMs, latest.waitMs);
+    } else {
+        std::snprintf(line, sizeof(line), "CPU %5.2f GPU N/A WAIT %5.2f MS", latest.cpuMs, latest.waitMs);
+    }
+    lines[2] = line;
+
+    // The panel is as wide as the graph or the longest line, whichever is wider
+    const float panelX = 10.0f;
+    const float panelY = 10.0f;
+    float contentW = HUD_GRAPH_FRAMES * 3.0f;
+    for (const std::string& text : lines) {
+        contentW = std::max(contentW, text.size() * HUD_CELL_WIDTH * HUD_TEXT_SCALE);
+    }
+    const float panelW = contentW + 20.0f;
+    const float lineH = HUD_CELL_HEIGHT * HUD_TEXT_SCALE + 4.0f;
+    const float graphH = 60.0f;
+    const float panelH = 10.0f + 3 * lineH + graphH + 10.0f;
+
+    vertices.clear();
+    addRect(panelX, panelY, panelW, panelH, 0.0f, 0.0f, 0.0f, 0.6f);
+
+    float textX = panelX + 10.0f;
+    float textY = panelY + 10.0f;
+    addText(lines[0], textX, textY, 1.0f, 1.0f, 0.4f);
+    textY += lineH;
+    addText(lines[1], textX, textY, 1.0f, 1.0f, 1.0f);
+    textY += lineH;
+    addText(lines[2], textX, textY, 1.0f, 1.0f, 1.0f);
+    textY += lineH;
+
+    // Frame time graph, newest frame on the right
+    float graphBottom = textY + graphH;
+    int frames = std::min(stats.getCount(), HUD_GRAPH_FRAMES);
+    for (int age = 0; age < frames; age++) {
+        float ms = stats.getSample(age).frameMs;
+        float h = std::min(ms, HUD_GRAPH_MAX_MS) / HUD_GRAPH_MAX_MS * graphH;
+        float x = textX + (HUD_GRAPH_FRAMES - 1 - age) * 3.0f;
+        if (ms <= 17.5f) {
+            addRect(x, graphBottom - h, 2.0f, h, 0.2f, 0.9f, 0.2f, 0.9f);
+        } else if (ms <= 34.0f) {
+            addRect(x, graphBottom - h, 2.0f, h, 0.95f, 0.8f, 0.1f, 0.9f);
+        } else {
+            addRect(x, graphBottom - h, 2.0f, h, 0.95f, 0.2f, 0.2f, 0.9f);
+        }
+    }
+    // 60 FPS reference line
+    float targetY = graphBottom - 16.7f / HUD_GRAPH_MAX_MS * graphH;
+    addRect(textX, targetY, HUD_GRAPH_FRAMES * 3.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.5f);
+
+    // Upload (orphaning the old storage) and draw everything in one call
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    size_t bytes = vertices.size() * sizeof(Vertex);
+    if (bytes > vboCapacity) {
+        vboCapacity = bytes * 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glViewport(0, 0, windowWidth, windowHeight);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(programID);
+    glUniform2f(screenLoc, static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_BLEND);
+}
@@ -0,0 +1,118 @@
+#include "../include/image_io.h"
+#include <cstdio>
+
+// 64-bit file offsets, posters can exceed 2 GiB
+#ifdef _WIN32
+#define seekFile(file, offset) _fseeki64(file, static_cast<__int64>(offset), SEEK_SET)
+#else
+#define seekFile(file, offset) fseeko(file, static_cast<off_t>(offset), SEEK_SET)
+#endif
+
+bool writePPM(const std::string& filePath, int width, int height, const std::vector<unsigned char>& pixels) {
+    if (pixels.size() < static_cast<size_t>(width) * height * 4) {
+        std::cerr << "ERROR::IMAGE::NOT_ENOUGH_PIXELS: " << filePath << std::endl;
+        return false;
+    }
+    std::FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::IMAGE::CANNOT_OPEN_FILE: " << filePath << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* source = pixels.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    if (!ok) {
+        std::cerr << "ERROR::IMAGE::WRITE_FAILED: " << filePath << std::endl;
+    }
+    return ok;
+}
+
+bool readPPM(const std::string& filePath, int& width, int& height, std::vector<unsigned char>& pixels) {
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    int maxValue = 0;
+    // The single whitespace byte after maxval is consumed by the trailing %*c
+    bool ok = std::fscanf(file, "P6 %d %d %d%*c", &width, &height, &maxValue) == 3 &&
+              width > 0 && height > 0 && maxValue == 255;
+    if (ok) {
+        std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (size_t i = 0; ok && i < static_cast<size_t>(width) * height; i++) {
+            pixels[i * 4 + 0] = rgb[i * 3 + 0];
+            pixels[i * 4 + 1] = rgb[i * 3 + 1];
+            pixels[i * 4 + 2] = rgb[i * 3 + 2];
+            pixels[i * 4 + 3] = 255;
+        }
+    }
+    std::fclose(file);
+    if (!ok) {
+        std::cerr << "ERROR::IMAGE::BAD_PPM: " << filePath << std::endl;
+    }
+    return ok;
+}
+
+PPMTileWriter::PPMTileWriter() : file(nullptr), width(0), height(0), headerSize(0), failed(false) {
+}
+
+PPMTileWriter::~PPMTileWriter() {
+    close();
+}
+
+bool PPMTileWriter::open(const std::string& filePath, int imageWidth, int imageHeight) {
+    close();
+    file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::IMAGE::CANNOT_OPEN_FILE: " << filePath << std::endl;
+        return false;
+    }
+    width = imageWidth;
+    height = imageHeight;
+    failed = false;
+    int written = std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    headerSize = written > 0 ? static_cast<uint64_t>(written) : 0;
+    return written > 0;
+}
+
+bool PPMTileWriter::writeTile(int x, int y, int tileWidth, int tileHeight, const std::vector<unsigned char>& pixels) {
+    if (!file || failed || x < 0 || y < 0 || x + tileWidth > width || y + tileHeight > height ||
+        pixels.size() < static_cast<size_t>(tileWidth) * tileHeight * 4) {
+        failed = true;
+        return false;
+    }
+    row.resize(static_cast<size_t>(tileWidth) * 3);
+    for (int ty = 0; ty < tileHeight && !failed; ty++) {
+        const unsigned char* source = pixels.data() + static_cast<size_t>(ty) * tileWidth * 4;
+        for (int tx = 0; tx < tileWidth; tx++) {
+            row[tx * 3 + 0] = source[tx * 4 + 0];
+            row[tx * 3 + 1] = source[tx * 4 + 1];
+            row[tx * 3 + 2] = source[tx * 4 + 2];
+        }
+        uint64_t offset = headerSize + (static_cast<uint64_t>(y + ty) * width + x) * 3;
+        failed = seekFile(file, offset) != 0 || std::fwrite(row.data(), 1, row.size(), file) != row.size();
+    }
+    if (failed) {
+        std::cerr << "ERROR::IMAGE::WRITE_FAILED (tile at " << x << ", " << y << ")" << std::endl;
+    }
+    return !failed;
+}
+
+bool PPMTileWriter::close() {
+    if (file) {
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+    }
+    return !failed;
+}
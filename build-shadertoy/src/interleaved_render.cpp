@@ -0,0 +1,174 @@
+#include "../include/interleaved_render.h"
+#include "../include/trace.h"
+
+// Pixel offsets of the 2x2 pattern, diagonal first so two frames already cover both axes
+static const int QUARTER_OFFSETS[4][2] = {{0, 0}, {1, 1}, {1, 0}, {0, 1}};
+
+// Reconstruction pass: one fragment per pixel of the full frame
+static const char* reconstructFragmentShader = R"(
+    #version 330 core
+    in vec2 fragCoord;
+    out vec4 fragColor;
+
+    uniform sampler2D uShaded;      // This frame's pixels, one texel per stride cell
+    uniform sampler2D uHistory;     // Previous reconstructed frame
+    uniform vec4 uInterleave;       // Stride (xy) and offset (zw), as the wrapper's iInterleave
+    uniform int uHistoryMode;       // 0 = none, 1 = clamped to the neighbours, 2 = as is
+
+    ivec2 stride;
+    ivec2 maxCell;
+
+    vec4 shadedCell(ivec2 cell) {
+        return texelFetch(uShaded, clamp(cell, ivec2(0), maxCell), 0);
+    }
+
+    void main() {
+        stride = ivec2(uInterleave.xy);
+        maxCell = textureSize(uShaded, 0) - 1;
+        ivec2 p = ivec2(gl_FragCoord.xy);
+        bool checkerboard = stride.y == 1;
+        ivec2 offset = checkerboard ? ivec2((p.y + int(uInterleave.z)) & 1, 0) : ivec2(uInterleave.zw);
+        ivec2 cell = p / stride;
+        if (p - cell * stride == offset) {
+            fragColor = shadedCell(cell);
+            return;
+        }
+
+        vec4 a, b, c, d, spatial;
+        if (checkerboard) {
+            // The four direct neighbours were all shaded this frame
+            a = shadedCell(ivec2(p.x - 1, p.y) / stride);
+            b = shadedCell(ivec2(p.x + 1, p.y) / stride);
+            c = shadedCell(ivec2(p.x, p.y - 1) / stride);
+            d = shadedCell(ivec2(p.x, p.y + 1) / stride);
+            spatial = (a + b + c + d) * 0.25;
+        } else {
+            // Bilinear between the four nearest shaded pixels
+            ivec2 base = (p - offset) >> 1;
+            a = shadedCell(base);
+            b = shadedCell(base + ivec2(1, 0));
+            c = shadedCell(base + ivec2(0, 1));
+            d = shadedCell(base + ivec2(1, 1));
+            vec2 f = vec2(p - offset - base * 2) * 0.5;
+            spatial = mix(mix(a, b, f.x), mix(c, d, f.x), f.y);
+        }
+        if (uHistoryMode == 0) {
+            fragColor = spatial;
+            return;
+        }
+        vec4 history = texelFetch(uHistory, p, 0);
+        fragColor = uHistoryMode == 2 ? history : clamp(history, min(min(a, b), min(c, d)), max(max(a, b), max(c, d)));
+    }
+)";
+
+const char* getInterleaveModeName(InterleaveMode mode) {
+    switch (mode) {
+        case INTERLEAVE_OFF: return "off";
+        case INTERLEAVE_CHECKERBOARD: return "checkerboard";
+        case INTERLEAVE_QUARTER: return "quarter";
+        default: return "unknown";
+    }
+}
+
+bool parseInterleaveMode(const std::string& name, InterleaveMode& mode) {
+    for (int i = 0; i < INTERLEAVE_MODE_COUNT; i++) {
+        if (name == getInterleaveModeName(static_cast<InterleaveMode>(i))) {
+            mode = static_cast<InterleaveMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+InterleavedRenderer::InterleavedRenderer()
+    : mode(INTERLEAVE_OFF), phase(0), historyValid(false), still(false), current(0) {
+}
+
+bool InterleavedRenderer::init() {
+    if (!reconstruct.loadFromStrings(defaultVertexShader, reconstructFragmentShader)) {
+        std::cerr << "Failed to compile the interleaved reconstruction shader!" << std::endl;
+        return false;
+    }
+    reconstruct.use();
+    reconstruct.setInt("uShaded", 0);
+    reconstruct.setInt("uHistory", 1);
+    glUseProgram(0);
+    return true;
+}
+
+void InterleavedRenderer::setMode(InterleaveMode value) {
+    mode = value;
+    phase = 0;
+    historyValid = false;
+}
+
+bool InterleavedRenderer::begin(int width, int height, bool stillFrame) {
+    if (mode == INTERLEAVE_OFF || reconstruct.getProgramID() == 0) {
+        return false;
+    }
+    int phases = mode == INTERLEAVE_CHECKERBOARD ? 2 : 4;
+    phase = (phase + 1) % phases;
+    still = stillFrame;
+    if (frames[0].getWidth() != width || frames[0].getHeight() != height) {
+        historyValid = false;
+    }
+    int shadedWidth = (width + 1) / 2;
+    int shadedHeight = mode == INTERLEAVE_CHECKERBOARD ? height : (height + 1) / 2;
+    if (!shaded.resize(shadedWidth, shadedHeight) || !frames[0].resize(width, height) ||
+        !frames[1].resize(width, height)) {
+        return false;
+    }
+    shaded.bind();
+    return true;
+}
+
+void InterleavedRenderer::getInterleave(float values[4]) const {
+    if (mode == INTERLEAVE_CHECKERBOARD) {
+        // The x offset alternates per row, starting at phase
+        values[0] = 2.0f;
+        values[1] = 1.0f;
+        values[2] = static_cast<float>(phase);
+        values[3] = 0.0f;
+    } else if (mode == INTERLEAVE_QUARTER) {
+        values[0] = 2.0f;
+        values[1] = 2.0f;
+        values[2] = static_cast<float>(QUARTER_OFFSETS[phase][0]);
+        values[3] = static_cast<float>(QUARTER_OFFSETS[phase][1]);
+    } else {
+        values[0] = values[1] = values[2] = values[3] = 0.0f;
+    }
+}
+
+void InterleavedRenderer::resolve(GLuint quadVAO, int windowWidth, int windowHeight, GLuint screenFramebuffer) {
+    TRACE_SCOPE("interleave reconstruct");
+    float interleave[4];
+    getInterleave(interleave);
+    RenderTarget& output = frames[current];
+    const RenderTarget& history = frames[1 - current];
+
+    output.bind();
+    reconstruct.use();
+    reconstruct.setVec4("uInterleave", interleave[0], interleave[1], interleave[2], interleave[3]);
+    reconstruct.setInt("uHistoryMode", historyValid ? (still ? 2 : 1) : 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, shaded.getTexture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, history.getTexture());
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    output.blitToScreen(windowWidth, windowHeight, screenFramebuffer);
+    current = 1 - current;
+    historyValid = true;
+}
+
+void InterleavedRenderer::release() {
+    shaded.release();
+    frames[0].release();
+    frames[1].release();
+    historyValid = false;
+}
@@ -0,0 +1,56 @@
+#include "../include/latency.h"
+#include <algorithm>
+
+LatencyTracker::LatencyTracker()
+    : enabled(false), hasPending(false), lastCountedMs(0), pendingAgeMs(0.0f), pendingSeenCounter(0) {
+}
+
+void LatencyTracker::onInput(Uint32 eventTimestampMs) {
+    if (!enabled || eventTimestampMs <= lastCountedMs) {
+        return;
+    }
+    // SDL event timestamps only have millisecond resolution, so we take the age of
+    // the event once and measure the rest of the path with the performance counter
+    float ageMs = static_cast<float>(SDL_GetTicks() - eventTimestampMs);
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (!hasPending) {
+        hasPending = true;
+        pendingAgeMs = ageMs;
+        pendingSeenCounter = now;
+    }
+    lastCountedMs = std::max(lastCountedMs, eventTimestampMs);
+}
+
+void LatencyTracker::onFramePresented() {
+    if (!enabled || !hasPending) {
+        return;
+    }
+    Uint64 now = SDL_GetPerformanceCounter();
+    float sinceSeenMs = (now - pendingSeenCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+    samples.push_back(pendingAgeMs + sinceSeenMs);
+    hasPending = false;
+}
+
+void LatencyTracker::printReport() const {
+    if (samples.empty()) {
+        std::cout << "Input latency: no samples (move the mouse while the renderer runs)" << std::endl;
+        return;
+    }
+    std::vector<float> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) {
+        size_t index = static_cast<size_t>(p / 100.0f * (sorted.size() - 1) + 0.5f);
+        return sorted[std::min(index, sorted.size() - 1)];
+    };
+    float total = 0.0f;
+    for (float sample : sorted) {
+        total += sample;
+    }
+    std::cout << "Input-to-present latency over " << sorted.size() << " frames (ms): "
+              << "min " << sorted.front()
+              << " mean " << total / sorted.size()
+              << " p50 " << percentile(50.0f)
+              << " p95 " << percentile(95.0f)
+              << " p99 " << percentile(99.0f)
+              << " max " << sorted.back() << std::endl;
+}
@@ -0,0 +1,255 @@
+#include "../include/loop_cache.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// The probe steps iTime in eighths of a second on frames this small
+const float LOOP_PROBE_STEP = 0.125f;
+const int LOOP_PROBE_WIDTH = 64;
+const int LOOP_PROBE_HEIGHT = 36;
+// Largest difference of a channel (0-255) at which two probe frames still count as the
+// same; a period only needs to hide the rounding of iTime, while a difference in one
+// thin feature has to count
+const int LOOP_PROBE_TOLERANCE = 8;
+
+// Playback pass: the cached frame stretched over the window
+static const char* playbackFragmentShader = R"(
+    #version 330 core
+    in vec2 fragCoord;
+    out vec4 fragColor;
+
+    uniform sampler2D uFrame;
+
+    void main() {
+        fragColor = vec4(texture(uFrame, fragCoord).rgb, 1.0);
+    }
+)";
+
+float parseLoopPeriod(const std::string& shaderToyCode) {
+    const std::string directive = "// loop-period:";
+    size_t start = shaderToyCode.find(directive);
+    if (start == std::string::npos) {
+        return 0.0f;
+    }
+    float period = static_cast<float>(std::atof(shaderToyCode.c_str() + start + directive.size()));
+    return std::max(0.0f, period);
+}
+
+// Draw the program at one time into the bound probe target and read it back
+static void renderProbeFrame(ShaderManager& shader, float time, std::vector<unsigned char>& pixels) {
+    shader.setupShaderToyUniforms(LOOP_PROBE_WIDTH, LOOP_PROBE_HEIGHT, time, LOOP_PROBE_STEP,
+                                  static_cast<int>(time * 60.0f), 0, 0, false);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    pixels.resize(LOOP_PROBE_WIDTH * LOOP_PROBE_HEIGHT * 4);
+    glReadPixels(0, 0, LOOP_PROBE_WIDTH, LOOP_PROBE_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+static bool sameFrame(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])) > LOOP_PROBE_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float probeLoopPeriod(ShaderManager& shader, GLuint quadVAO, float maxPeriod) {
+    TRACE_SCOPE("loop period probe");
+    FramebufferScope binding;
+    RenderTarget target;
+    float found = 0.0f;
+    if (target.resize(LOOP_PROBE_WIDTH, LOOP_PROBE_HEIGHT)) {
+        // Two periods' worth of frames, from a start off the whole seconds
+        int steps = static_cast<int>(maxPeriod / LOOP_PROBE_STEP);
+        std::vector<std::vector<unsigned char>> sequence(2 * steps + 1);
+        target.bind();
+        shader.use();
+        shader.setupShaderToyTile(0, 0, 0, 0);
+        shader.setupShaderToyJitter(0.0f, 0.0f);
+        shader.setupShaderToyInterleave(0.0f, 0.0f, 0.0f, 0.0f);
+        glBindVertexArray(quadVAO);
+        for (size_t i = 0; i < sequence.size(); i++) {
+            renderProbeFrame(shader, 0.37f + i * LOOP_PROBE_STEP, sequence[i]);
+        }
+        glBindVertexArray(0);
+        // A period has every frame repeat, not just a few: animations that rest for a
+        // while would match at any shift within the rest
+        for (int shift = 2; shift <= steps && found == 0.0f; shift++) {
+            bool repeats = true;
+            for (size_t i = 0; i + shift < sequence.size() && repeats; i++) {
+                repeats = sameFrame(sequence[i], sequence[i + shift]);
+            }
+            if (repeats) {
+                found = shift * LOOP_PROBE_STEP;
+            }
+        }
+    }
+    return found;
+}
+
+LoopFrameCache::LoopFrameCache()
+    : enabled(false), pixelBuffer(0), compressed(false), period(0.0f), settleStart(-1e9f), program(0),
+      slotSeconds(0.0f), bytesPerFrame(0), framesFilled(0), currentSlot(0), framesPlayed(0), invalidations(0) {
+}
+
+LoopFrameCache::~LoopFrameCache() {
+    release();
+}
+
+bool LoopFrameCache::init() {
+    if (!playback.loadFromStrings(defaultVertexShader, playbackFragmentShader)) {
+        std::cerr << "Failed to compile the loop cache playback shader!" << std::endl;
+        return false;
+    }
+    playback.use();
+    playback.setInt("uFrame", 0);
+    glUseProgram(0);
+    // DXT1 is 4 bits per pixel; the driver encodes it from the frame read back into a
+    // pixel buffer, so the frame never passes through client memory
+    compressed = GLEW_EXT_texture_compression_s3tc != 0;
+    return true;
+}
+
+void LoopFrameCache::setConfig(const LoopCacheConfig& value) {
+    config = value;
+    config.framesPerSecond = std::max(1.0f, config.framesPerSecond);
+    config.settleSeconds = std::max(0.0f, config.settleSeconds);
+    clearFrames();
+}
+
+void LoopFrameCache::clearFrames() {
+    if (framesFilled > 0) {
+        invalidations++;
+    }
+    for (GLuint texture : frames) {
+        if (texture) {
+            glDeleteTextures(1, &texture);
+        }
+    }
+    frames.clear();
+    framesFilled = 0;
+    currentSlot = 0;
+}
+
+bool LoopFrameCache::begin(const AccumulationInputs& inputs, float loopPeriod, float clockSeconds) {
+    AccumulationInputs next = inputs;
+    next.time = 0.0f;
+    next.program = 0;
+    // Another shader, size or period is a new loop and starts at once
+    if (next.shader != key.shader || next.width != key.width || next.height != key.height || loopPeriod != period) {
+        clearFrames();
+        key = next;
+        period = loopPeriod;
+        settleStart = -1e9f;
+        return true;
+    }
+    // The mouse is part of the image: the frames are stale, and while it moves a cache
+    // would be refilled every frame
+    if (!(next == key)) {
+        clearFrames();
+        key = next;
+        settleStart = clockSeconds;
+        return false;
+    }
+    return clockSeconds - settleStart >= config.settleSeconds;
+}
+
+bool LoopFrameCache::render(ShaderManager& shader, GLuint quadVAO, const AccumulationInputs& inputs, int frame) {
+    if (shader.getProgramID() != program) {
+        clearFrames();
+        program = shader.getProgramID();
+    }
+    if (frames.empty()) {
+        bytesPerFrame = compressed ? static_cast<size_t>((inputs.width + 3) / 4) * ((inputs.height + 3) / 4) * 8
+                                   : static_cast<size_t>(inputs.width) * inputs.height * 2;
+        // A loop that does not fit the budget gets fewer frames per second
+        size_t count = static_cast<size_t>(std::ceil(period * config.framesPerSecond));
+        count = std::min(count, config.budgetBytes / bytesPerFrame);
+        if (count < 2) {
+            return false;
+        }
+        frames.assign(count, 0);
+        slotSeconds = period / count;
+    }
+
+    float phase = std::fmod(inputs.time, period);
+    if (phase < 0.0f) {
+        phase += period;
+    }
+    int count = static_cast<int>(frames.size());
+    currentSlot = static_cast<int>(phase / slotSeconds + 0.5f) % count;
+    if (frames[currentSlot]) {
+        framesPlayed++;
+        return true;
+    }
+
+    TRACE_SCOPE("loop cache fill");
+    if (!capture.resize(inputs.width, inputs.height)) {
+        return false;
+    }
+    capture.bind();
+    shader.use();
+    shader.setupShaderToyUniforms(inputs.width, inputs.height, currentSlot * slotSeconds, slotSeconds, frame,
+                                  inputs.mouseX, inputs.mouseY, inputs.mouseDown);
+    shader.setupShaderToyTile(0, 0, 0, 0);
+    shader.setupShaderToyJitter(0.0f, 0.0f);
+    shader.setupShaderToyInterleave(0.0f, 0.0f, 0.0f, 0.0f);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (compressed) {
+        size_t size = static_cast<size_t>(inputs.width) * inputs.height * 4;
+        if (!pixelBuffer) {
+            glGenBuffers(1, &pixelBuffer);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_COPY);
+        glReadPixels(0, 0, inputs.width, inputs.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, inputs.width, inputs.height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5, 0, 0, inputs.width, inputs.height, 0);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    frames[currentSlot] = texture;
+    framesFilled++;
+    return true;
+}
+
+void LoopFrameCache::present(GLuint quadVAO, int windowWidth, int windowHeight, GLuint screenFramebuffer) {
+    if (frames.empty() || !frames[currentSlot]) {
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glViewport(0, 0, windowWidth, windowHeight);
+    playback.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, frames[currentSlot]);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void LoopFrameCache::release() {
+    int kept = invalidations;
+    clearFrames();
+    invalidations = kept;
+    capture.release();
+    if (pixelBuffer) {
+        glDeleteBuffers(1, &pixelBuffer);
+        pixelBuffer = 0;
+    }
+}
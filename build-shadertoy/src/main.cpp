@@ -1,5 +1,31 @@
 #include "../include/shader_manager.h"
 #include "../include/includes.h"
+#include "../include/options.h"
+#include "../include/trace.h"
+#include "../include/gpu_timer.h"
+#include "../include/frame_stats.h"
+#include "../include/hud.h"
+#include "../include/latency.h"
+#include "../include/render_target.h"
+#include "../include/watchdog.h"
+#include "../include/dynamic_resolution.h"
+#include "../include/quality_governor.h"
+#include "../include/accumulation.h"
+#include "../include/interleaved_render.h"
+#include "../include/foveated_render.h"
+#include "../include/time_sliced_render.h"
+#include "../include/depth_prepass.h"
+#include "../include/sdf_bake.h"
+#include "../include/loop_cache.h"
+#include "../include/frame_pacer.h"
+#include "../include/backend.h"
+#include "../include/image_io.h"
+#include "../include/async_readback.h"
+#include "../include/shared_frames.h"
+#include "../include/video_export.h"
+#include "../include/tiled_render.h"
+#include "../include/batch_render.h"
+#include <cstdio>
 
 
 // Window dimensions - now variables instead of constants
@@ -24,31 +50,6 @@ const std::vector<std::string> SHADER_NAMES = {
     "shader 11"
 };
 
-// Function to load shader code from a file
-std::string loadShaderFromFile(const std::string& filePath) {
-    std::string shaderCode;
-    std::ifstream shaderFile;
-    // Ensure ifstream objects can throw exceptions
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-        // Open file
-        shaderFile.open(filePath);
-        std::stringstream shaderStream;
-        // Read file's buffer contents into stream
-        shaderStream << shaderFile.rdbuf();
-        // Close file
-        shaderFile.close();
-        // Convert stream into string
-        shaderCode = shaderStream.str();
-    }
-    catch (std::ifstream::failure& e) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << filePath << std::endl;
-        std::cerr << "Exception: " << e.what() << std::endl;
-        return "";
-    }
-    return shaderCode;
-}
-
 // Function to get key name for display
 std::string getKeyName(int shaderIndex) {
     if (shaderIndex < 9) {
@@ -74,58 +75,36 @@ void handleResize(int width, int height) {
 }
 
 int main(int argc, char* argv[]) {
-    // Validate shader configuration
-    if (SHADER_NAMES.size() != NUM_SHADERS) {
-        std::cerr << "ERROR: Number of shader names (" << SHADER_NAMES.size()
-            << ") doesn't match NUM_SHADERS (" << NUM_SHADERS << ")" << std::endl;
-        return 1;
-    }
-
-    // Initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+    // Parse command line options
+    RenderOptions options;
+    if (!parseOptions(argc, argv, options)) {
         return 1;
     }
+    traceSetEnabled(!options.tracePath.empty());
 
-    // Set OpenGL attributes
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-
-    // Create window with resizable flag
-    SDL_Window* window = SDL_CreateWindow(
-        "ShaderToy Renderer",
-        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        WINDOW_WIDTH, WINDOW_HEIGHT,
-        SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
-    );
-
-    if (!window) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return 1;
+    // Video goes to stdout: keep the console output out of the stream
+    if (options.exportPath == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
     }
 
-    // Create OpenGL context
-    SDL_GLContext glContext = SDL_GL_CreateContext(window);
-    if (!glContext) {
-        std::cerr << "OpenGL context could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+    // Validate shader configuration
+    if (SHADER_NAMES.size() != NUM_SHADERS || SHADER_LOW_QUALITY_DEFINES.size() != NUM_SHADERS) {
+        std::cerr << "ERROR: Number of shader names (" << SHADER_NAMES.size()
+            << ") or low-quality define sets (" << SHADER_LOW_QUALITY_DEFINES.size()
+            << ") doesn't match NUM_SHADERS (" << NUM_SHADERS << ")" << std::endl;
         return 1;
     }
 
-    // Initialize GLEW
-    glewExperimental = GL_TRUE;
-    GLenum glewError = glewInit();
-    if (glewError != GLEW_OK) {
-        std::cerr << "GLEW could not be initialized! Error: " << glewGetErrorString(glewError) << std::endl;
-        SDL_GL_DeleteContext(glContext);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+    // Create the GL context: an SDL window, or an offscreen context rendering into an FBO
+    // (a poster only needs one tile, its full size can exceed the framebuffer limit)
+    WINDOW_WIDTH = options.posterPath.empty() ? options.width : std::min(options.width, options.tileSize);
+    WINDOW_HEIGHT = options.posterPath.empty() ? options.height : std::min(options.height, options.tileSize);
+    std::unique_ptr<RenderBackend> backend = createRenderBackend(options.backend);
+    if (!backend || !backend->init("ShaderToy Renderer", WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
         return 1;
     }
+    bool headless = backend->isHeadless();
 
     // Print key mapping information
     std::cout << "Shader Key Mappings:" << std::endl;
@@ -141,9 +120,6 @@ int main(int argc, char* argv[]) {
         std::string code = loadShaderFromFile(shaderPath);
         if (code.empty()) {
             std::cerr << "Failed to load shader" << i << ".glsl!" << std::endl;
-            SDL_GL_DeleteContext(glContext);
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return 1;
         }
         shaderCodes.push_back(code);
@@ -153,12 +129,8 @@ int main(int argc, char* argv[]) {
     std::vector<ShaderManager> shaderManagers(NUM_SHADERS);
     for (int i = 0; i < NUM_SHADERS; i++) {
         std::cout << "Compiling shader " << (i+1) << "..." << std::endl;
-        std::string fragmentShaderSource = createShaderToyFragmentShader(shaderCodes[i]);
-        if (!shaderManagers[i].loadFromStrings(defaultVertexShader, fragmentShaderSource)) {
+        if (!shaderManagers[i].loadShaderToy(shaderCodes[i])) {
             std::cerr << "Failed to load shader " << (i+1) << "!" << std::endl;
-            SDL_GL_DeleteContext(glContext);
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return 1;
         }
     }
@@ -167,6 +139,236 @@ int main(int argc, char* argv[]) {
     // Create full-screen quad
     GLuint quadVAO = createFullScreenQuad();
 
+    // Offline export: render one shader with a fixed clock and stream it, then quit
+    if (!options.exportPath.empty()) {
+        VideoExportSettings settings;
+        settings.path = options.exportPath;
+        settings.format = options.exportFormat;
+        settings.width = options.width;
+        settings.height = options.height;
+        settings.fps = options.exportFps;
+        settings.durationSeconds = options.exportSeconds;
+        int exportShader = std::min(options.startShader, NUM_SHADERS - 1);
+        bool exported = false;
+        if (options.exportWorkers > 1 || options.exportScaling) {
+            exported = exportVideoParallel(createShaderToyFragmentShader(shaderCodes[exportShader]), options.backend,
+                                           settings, options.exportWorkers, options.exportScaling);
+        } else {
+            exported = exportVideo(shaderManagers[exportShader], quadVAO, settings);
+        }
+        glDeleteVertexArrays(1, &quadVAO);
+        if (traceIsEnabled()) {
+            traceWriteJson(options.tracePath);
+        }
+        return exported ? 0 : 1;
+    }
+
+    // Tiled poster: one still of any size, written tile by tile, then quit
+    if (!options.posterPath.empty()) {
+        TiledRenderSettings settings;
+        settings.path = options.posterPath;
+        settings.width = options.width;
+        settings.height = options.height;
+        settings.tileSize = options.tileSize;
+        settings.time = options.posterTime;
+        int posterShader = std::min(options.startShader, NUM_SHADERS - 1);
+        bool rendered = renderTiled(shaderManagers[posterShader], quadVAO, settings);
+        glDeleteVertexArrays(1, &quadVAO);
+        if (traceIsEnabled()) {
+            traceWriteJson(options.tracePath);
+        }
+        return rendered ? 0 : 1;
+    }
+
+    // GPU timing of the shader draw, merged into the trace
+    GpuTimer drawTimer("draw");
+    drawTimer.init();
+
+    // Frame statistics and the performance overlay
+    FrameStats frameStats;
+    Hud hud;
+    hud.init();
+    hud.setVisible(options.showHud);
+    Uint64 perfFrequency = SDL_GetPerformanceFrequency();
+    Uint64 lastFrameStart = SDL_GetPerformanceCounter();
+
+    // Input-to-present latency measurement and late-latched mouse
+    LatencyTracker latency;
+    latency.setEnabled(options.measureLatency);
+    bool lateLatch = options.lateLatch;
+
+    // Frame-time watchdog: slow shaders step down to a reduced render scale, then a
+    // low-quality variant, then a frozen frame, rendered through an offscreen target
+    FrameWatchdog watchdog;
+    WatchdogConfig watchdogConfig;
+    watchdogConfig.budgetMs = options.frameBudgetMs;
+    watchdogConfig.overBudgetFrames = options.budgetFrames;
+    watchdog.setConfig(watchdogConfig);
+    // Offscreen runs are for reproducible output, never degrade them
+    watchdog.setEnabled(options.watchdog && !headless);
+    // Dynamic resolution: the render scale follows the measured frame cost; like the
+    // watchdog it renders through sceneTarget and is off for reproducible offscreen runs
+    DynamicResolution dynamicResolution;
+    DynamicResolutionConfig dynamicResolutionConfig;
+    dynamicResolutionConfig.targetMs = 1000.0f / options.targetFps;
+    dynamicResolutionConfig.minScale = options.minRenderScale;
+    dynamicResolution.setConfig(dynamicResolutionConfig);
+    dynamicResolution.setEnabled(options.dynamicResolution && !headless);
+    RenderTarget sceneTarget;
+    int sceneTargetShader = -1; // Shader whose last frame is in sceneTarget
+
+    // Progressive accumulation of still views (F10), one jittered sample per pixel per
+    // frame; Space pauses iTime so an animated shader can converge too
+    ProgressiveAccumulator accumulator;
+    if (options.accumulateSamples > 0) {
+        accumulator.setMaxSamples(options.accumulateSamples);
+        accumulator.setEnabled(true);
+    }
+    bool timePaused = options.paused;
+    float pausedTime = 0.0f;
+    float pausedSeconds = 0.0f;
+    AccumulationInputs previousInputs;
+
+    // Interleaved rendering (F11): shade half or a quarter of the pixels per frame and
+    // reconstruct the rest from the previous frame
+    InterleavedRenderer interleaved;
+    if (interleaved.init()) {
+        interleaved.setMode(options.interleaveMode);
+    }
+    bool previousInterleaved = false;
+
+    // Foveated rendering (F12): full resolution around the cursor, less towards the edges
+    FoveatedRenderer foveated;
+    FoveationConfig foveationConfig;
+    if (options.foveaRadius > 0.0f) {
+        foveationConfig.radius = options.foveaRadius;
+    }
+    if (options.foveaFalloff > 0.0f) {
+        foveationConfig.falloff = options.foveaFalloff;
+    }
+    foveated.setConfig(foveationConfig);
+    foveated.setEnabled(foveated.init() && options.foveaRadius > 0.0f);
+
+    // Time-sliced rendering: shaders slower than a frame fill the image a few tiles per
+    // frame, so input and the overlay stay at the frame rate
+    TimeSlicedRenderer timeSliced;
+    timeSliced.setBudgetMs(options.timeSliceMs);
+
+    // Depth prepass for the ray marchers that use the hook: rays start where a
+    // low-resolution cone march found no surface
+    DepthPrepass depthPrepass;
+    depthPrepass.setBlockSize(options.prepassBlock);
+    std::vector<bool> prepassShaders(NUM_SHADERS);
+    for (int i = 0; i < NUM_SHADERS; i++) {
+        prepassShaders[i] = options.prepassBlock > 0 && shaderUsesDepthPrepass(shaderCodes[i]);
+    }
+
+    // Baked distance volumes of the static scenes, from the shader_sdfbake cache (baked
+    // here with the shader's bounds if the cache has none for the current source)
+    std::vector<SdfVolumeTexture> sdfVolumes(NUM_SHADERS);
+    for (int i = 0; options.bakedSdf && i < NUM_SHADERS; i++) {
+        SdfBakeSettings settings;
+        SdfVolume volume;
+        if (!shaderHasStaticSdf(shaderCodes[i]) || !parseSdfBounds(shaderCodes[i], settings)) {
+            continue;
+        }
+        std::string cachePath = getSdfCachePath("..", "shader" + std::to_string(i + 1));
+        if (loadOrBakeSdfVolume(cachePath, shaderCodes[i], settings, quadVAO, volume) &&
+            sdfVolumes[i].upload(volume)) {
+            std::cout << "Baked SDF for shader" << i + 1 << ": " << volume.size[0] << "x" << volume.size[1] << "x"
+                      << volume.size[2] << ", voxel " << volume.voxelSize << std::endl;
+        }
+    }
+
+    // Loop cache: periodic shaders play back from cached frames after their first loop.
+    // A period on the command line covers every shader; with auto each shader's own
+    // declaration is used, or a probe here at startup (it renders a few hundred small
+    // frames, which would stall the window if it ran on the shader's first frame)
+    LoopFrameCache loopCache;
+    LoopCacheConfig loopConfig;
+    loopConfig.framesPerSecond = options.loopFps;
+    loopConfig.budgetBytes = static_cast<size_t>(options.loopBudgetMb) << 20;
+    loopCache.setConfig(loopConfig);
+    loopCache.setEnabled(options.loopPeriod != 0.0f && loopCache.init());
+    std::vector<float> loopPeriods(NUM_SHADERS, options.loopPeriod);
+    for (int i = 0; loopCache.isEnabled() && options.loopPeriod < 0.0f && i < NUM_SHADERS; i++) {
+        loopPeriods[i] = parseLoopPeriod(shaderCodes[i]);
+        if (loopPeriods[i] > 0.0f) {
+            continue;
+        }
+        loopPeriods[i] = probeLoopPeriod(shaderManagers[i], quadVAO);
+        std::cout << "Loop period of " << SHADER_NAMES[i] << ": ";
+        if (loopPeriods[i] > 0.0f) {
+            std::cout << loopPeriods[i] << " s" << std::endl;
+        } else {
+            std::cout << "none found" << std::endl;
+        }
+    }
+
+    // Quality variants (for the governor, the watchdog and F8) compile in the background,
+    // one per frame, so switching to one never stalls; --low-quality needs the first one now
+    bool forceLowQuality = options.lowQuality;
+    std::vector<std::vector<ShaderDefines>> qualityLevels(NUM_SHADERS);
+    std::vector<std::vector<std::string>> qualityLevelKeys(NUM_SHADERS);
+    for (int i = 0; i < NUM_SHADERS; i++) {
+        qualityLevels[i] = getShaderQualityLevels(i);
+        for (const ShaderDefines& defines : qualityLevels[i]) {
+            shaderManagers[i].requestVariant(defines);
+            qualityLevelKeys[i].push_back(getShaderDefinesKey(defines));
+        }
+        shaderManagers[i].requestVariant(SHADER_SINGLE_SAMPLE_DEFINES[i]);
+    }
+    if (forceLowQuality) {
+        int startShader = std::min(options.startShader, NUM_SHADERS - 1);
+        shaderManagers[startShader].compileVariant(qualityLevels[startShader].back());
+    }
+
+    // Quality governor: the highest-quality variant that fits the --target-fps budget at
+    // the window size, from variant costs measured on this machine in earlier runs too
+    const std::string qualityCachePath = "../quality.cache";
+    QualityGovernor governor;
+    QualityGovernorConfig governorConfig;
+    governorConfig.budgetMs = 1000.0f / options.targetFps;
+    governor.setConfig(governorConfig);
+    governor.setEnabled(options.qualityGovernor && !headless);
+    if (governor.isEnabled()) {
+        governor.load(qualityCachePath, getQualityMachineKey());
+    }
+
+    // Fence-based limit on how far the driver may run ahead
+    FramePacer framePacer;
+    framePacer.setMaxFramesInFlight(options.framesInFlight);
+    std::cout << "Max frames in flight: " << framePacer.getMaxFramesInFlight() << std::endl;
+
+    // Screenshots (F6), frame dumps and --output go through a PBO ring; a consumer
+    // thread writes the files so the render thread never waits on glReadPixels
+    AsyncReadback readback;
+    int framesDumped = 0;
+
+    // Frames for other processes: the same readback, published from the consumer thread
+    const std::string sharedFrameTag = "<shared memory>";
+    SharedFrameWriter sharedFrames;
+    if (!options.sharedMemoryName.empty() && !sharedFrames.open(options.sharedMemoryName, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        return 1;
+    }
+
+    readback.start([&options, &framesDumped, &sharedFrames, &sharedFrameTag](ReadbackFrame& captured) {
+        if (captured.tag == sharedFrameTag) {
+            sharedFrames.publish(captured.pixels, captured.width, captured.height, captured.frameIndex);
+            return;
+        }
+        if (!writePPM(captured.tag, captured.width, captured.height, captured.pixels)) {
+            return;
+        }
+        if (!options.dumpFramesPrefix.empty() && captured.tag.compare(0, options.dumpFramesPrefix.size(),
+                                                                      options.dumpFramesPrefix) == 0) {
+            framesDumped++;
+        } else {
+            std::cout << "Frame " << captured.frameIndex << " written to: " << captured.tag << std::endl;
+        }
+    });
+    bool screenshotRequested = false;
+
     // Initialize viewport
     glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
@@ -185,98 +387,572 @@ int main(int argc, char* argv[]) {
     bool mouseDown = false;
 
     // Active shader (0-based index)
-    int activeShader = 0;
-    std::cout << "Starting with shader 1 (" << SHADER_NAMES[activeShader] << ")" << std::endl;
+    int activeShader = std::min(options.startShader, NUM_SHADERS - 1);
+    std::cout << "Starting with shader " << getKeyName(activeShader)
+        << " (" << SHADER_NAMES[activeShader] << ")" << std::endl;
 
     // Main loop
     while (!quit) {
+        TRACE_SCOPE("frame");
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        float frameMs = (frameStart - lastFrameStart) * 1000.0f / perfFrequency;
+        lastFrameStart = frameStart;
+
+        // Wait until the GPU is at most framesInFlight - 1 frames behind
+        float waitMs = framePacer.waitForFrameSlot();
+
         // Handle events
-        while (SDL_PollEvent(&e) != 0) {
-            if (e.type == SDL_QUIT) {
-                quit = true;
-            }
-            else if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.sym == SDLK_ESCAPE) {
+        {
+            TRACE_SCOPE("event pump");
+            // Offscreen backends have no window and no input
+            while (!headless && SDL_PollEvent(&e) != 0) {
+                if (e.type == SDL_QUIT) {
                     quit = true;
                 }
-                // Handle shader switching with number keys (1-9)
-                else if (e.key.keysym.sym >= SDLK_1 && e.key.keysym.sym <= SDLK_9) {
-                    int newShader = e.key.keysym.sym - SDLK_1;
-                    if (newShader < NUM_SHADERS) {
-                        activeShader = newShader;
-                        std::cout << "Switched to shader " << getKeyName(activeShader)
-                            << " (" << SHADER_NAMES[activeShader] << ")" << std::endl;
+                else if (e.type == SDL_KEYDOWN) {
+                    if (e.key.keysym.sym == SDLK_ESCAPE) {
+                        quit = true;
                     }
-                }
-                // Handle shader switching with letter keys (A-Z for shaders 10-35)
-                else if (e.key.keysym.sym >= SDLK_a && e.key.keysym.sym <= SDLK_z) {
-                    int newShader = (e.key.keysym.sym - SDLK_a) + 9; // A = shader 10, B = shader 11, etc.
-                    if (newShader < NUM_SHADERS) {
-                        activeShader = newShader;
-                        std::cout << "Switched to shader " << getKeyName(activeShader)
-                            << " (" << SHADER_NAMES[activeShader] << ")" << std::endl;
+                    // F1 toggles the performance overlay
+                    else if (e.key.keysym.sym == SDLK_F1) {
+                        hud.toggle();
+                    }
+                    // F2 writes the trace recorded so far
+                    else if (e.key.keysym.sym == SDLK_F2) {
+                        if (traceIsEnabled()) {
+                            traceWriteJson(options.tracePath);
+                        } else {
+                            std::cout << "Tracing is disabled, start with --trace <file>" << std::endl;
+                        }
+                    }
+                    // F3 prints the input latency distribution
+                    else if (e.key.keysym.sym == SDLK_F3) {
+                        if (latency.isEnabled()) {
+                            latency.printReport();
+                        } else {
+                            std::cout << "Latency measurement is disabled, start with --latency" << std::endl;
+                        }
+                    }
+                    // F4 toggles the late-latched mouse
+                    else if (e.key.keysym.sym == SDLK_F4) {
+                        lateLatch = !lateLatch;
+                        std::cout << "Late-latched mouse " << (lateLatch ? "enabled" : "disabled") << std::endl;
+                    }
+                    // F5 toggles the frame-time watchdog
+                    else if (e.key.keysym.sym == SDLK_F5) {
+                        watchdog.setEnabled(!watchdog.isEnabled());
+                        std::cout << "Watchdog " << (watchdog.isEnabled() ? "enabled" : "disabled") << std::endl;
+                    }
+                    // F7 toggles dynamic resolution
+                    else if (e.key.keysym.sym == SDLK_F7) {
+                        dynamicResolution.setEnabled(!dynamicResolution.isEnabled());
+                        std::cout << "Dynamic resolution " << (dynamicResolution.isEnabled() ? "enabled" : "disabled") << std::endl;
+                    }
+                    // F8 toggles the low-quality variant of every shader
+                    else if (e.key.keysym.sym == SDLK_F8) {
+                        forceLowQuality = !forceLowQuality;
+                        std::cout << "Low quality " << (forceLowQuality ? "enabled" : "disabled") << std::endl;
+                    }
+                    // F9 toggles the quality governor
+                    else if (e.key.keysym.sym == SDLK_F9) {
+                        if (!governor.isEnabled()) {
+                            governor.load(qualityCachePath, getQualityMachineKey());
+                        }
+                        governor.setEnabled(!governor.isEnabled());
+                        std::cout << "Quality governor " << (governor.isEnabled() ? "enabled" : "disabled") << std::endl;
+                    }
+                    // F10 toggles progressive accumulation
+                    else if (e.key.keysym.sym == SDLK_F10) {
+                        accumulator.setEnabled(!accumulator.isEnabled());
+                        std::cout << "Progressive accumulation " << (accumulator.isEnabled() ? "enabled" : "disabled")
+                                  << " (" << accumulator.getMaxSamples() << " samples)" << std::endl;
+                    }
+                    // F11 cycles the interleaved rendering modes
+                    else if (e.key.keysym.sym == SDLK_F11) {
+                        interleaved.setMode(static_cast<InterleaveMode>((interleaved.getMode() + 1) % INTERLEAVE_MODE_COUNT));
+                        interleaved.reset();
+                        std::cout << "Interleaved rendering: " << getInterleaveModeName(interleaved.getMode()) << std::endl;
+                    }
+                    // F12 toggles foveated rendering
+                    else if (e.key.keysym.sym == SDLK_F12) {
+                        foveated.setEnabled(!foveated.isEnabled());
+                        std::cout << "Foveated rendering " << (foveated.isEnabled() ? "enabled" : "disabled") << std::endl;
+                    }
+                    // Space pauses and resumes iTime
+                    else if (e.key.keysym.sym == SDLK_SPACE) {
+                        timePaused = !timePaused;
+                        std::cout << "Time " << (timePaused ? "paused" : "resumed") << " at " << pausedTime << " s" << std::endl;
+                    }
+                    // F6 saves a screenshot of the shader output
+                    else if (e.key.keysym.sym == SDLK_F6) {
+                        screenshotRequested = true;
+                    }
+                    // Handle shader switching with number keys (1-9)
+                    else if (e.key.keysym.sym >= SDLK_1 && e.key.keysym.sym <= SDLK_9) {
+                        int newShader = e.key.keysym.sym - SDLK_1;
+                        if (newShader < NUM_SHADERS) {
+                            activeShader = newShader;
+                            dynamicResolution.reset();
+                            interleaved.reset();
+                            governor.reset(SHADER_NAMES[activeShader]);
+                            std::cout << "Switched to shader " << getKeyName(activeShader)
+                                << " (" << SHADER_NAMES[activeShader] << ")" << std::endl;
+                        }
+                    }
+                    // Handle shader switching with letter keys (A-Z for shaders 10-35)
+                    else if (e.key.keysym.sym >= SDLK_a && e.key.keysym.sym <= SDLK_z) {
+                        int newShader = (e.key.keysym.sym - SDLK_a) + 9; // A = shader 10, B = shader 11, etc.
+                        if (newShader < NUM_SHADERS) {
+                            activeShader = newShader;
+                            dynamicResolution.reset();
+                            interleaved.reset();
+                            governor.reset(SHADER_NAMES[activeShader]);
+                            std::cout << "Switched to shader " << getKeyName(activeShader)
+                                << " (" << SHADER_NAMES[activeShader] << ")" << std::endl;
+                        }
                     }
                 }
-            }
-            else if (e.type == SDL_WINDOWEVENT) {
-                if (e.window.event == SDL_WINDOWEVENT_RESIZED) {
-                    // Handle window resize
-                    handleResize(e.window.data1, e.window.data2);
+                else if (e.type == SDL_WINDOWEVENT) {
+                    if (e.window.event == SDL_WINDOWEVENT_RESIZED) {
+                        // Handle window resize
+                        handleResize(e.window.data1, e.window.data2);
+                        backend->resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+                        dynamicResolution.reset();
+                        governor.reset(SHADER_NAMES[activeShader]);
+                    }
                 }
-            }
-            else if (e.type == SDL_MOUSEMOTION) {
-                SDL_GetMouseState(&mouseX, &mouseY);
-            }
-            else if (e.type == SDL_MOUSEBUTTONDOWN) {
-                if (e.button.button == SDL_BUTTON_LEFT) {
-                    mouseDown = true;
+                else if (e.type == SDL_MOUSEMOTION) {
                     SDL_GetMouseState(&mouseX, &mouseY);
+                    latency.onInput(e.motion.timestamp);
                 }
-            }
-            else if (e.type == SDL_MOUSEBUTTONUP) {
-                if (e.button.button == SDL_BUTTON_LEFT) {
-                    mouseDown = false;
+                else if (e.type == SDL_MOUSEBUTTONDOWN) {
+                    if (e.button.button == SDL_BUTTON_LEFT) {
+                        mouseDown = true;
+                        SDL_GetMouseState(&mouseX, &mouseY);
+                        latency.onInput(e.button.timestamp);
+                    }
+                }
+                else if (e.type == SDL_MOUSEBUTTONUP) {
+                    if (e.button.button == SDL_BUTTON_LEFT) {
+                        mouseDown = false;
+                        latency.onInput(e.button.timestamp);
+                    }
                 }
             }
         }
 
-        // Calculate time
+        // Calculate time; offscreen runs step a fixed 60 Hz clock so output is reproducible
         lastTime = currentTime;
-        currentTime = SDL_GetTicks();
-        deltaTime = (currentTime - lastTime) / 1000.0f;
-        float time = currentTime / 1000.0f;
+        currentTime = headless ? static_cast<Uint32>(frame * 1000.0 / 60.0) : SDL_GetTicks();
+        deltaTime = headless ? 1.0f / 60.0f : (currentTime - lastTime) / 1000.0f;
+        float clockSeconds = headless ? frame / 60.0f : currentTime / 1000.0f;
+        // While paused iTime stands still; it resumes where it stopped
+        float time = clockSeconds - pausedSeconds;
+        if (timePaused) {
+            pausedSeconds += time - pausedTime;
+            time = pausedTime;
+            deltaTime = 0.0f;
+        }
+        pausedTime = time;
+
+        // Let the watchdog pick how this frame is rendered; a probe renders one
+        // frame a level higher to test whether there is headroom again
+        DegradeLevel degradeLevel = watchdog.getLevel(activeShader);
+        bool probe = watchdog.shouldProbe(activeShader, clockSeconds);
+        if (probe) {
+            degradeLevel = static_cast<DegradeLevel>(degradeLevel - 1);
+        }
+        // Nothing to keep presenting yet (shader switch or resize): render one frame
+        if (degradeLevel == DEGRADE_FROZEN && sceneTargetShader != activeShader) {
+            degradeLevel = DEGRADE_LOW_QUALITY;
+        }
+        // Time slicing keeps slow frames from blocking by itself, the watchdog stays out
+        bool timeSlice = timeSliced.isEnabled();
+        // Cached loops play back at almost no cost, so they too keep the watchdog out
+        bool loop = false;
+        if (loopCache.isEnabled() && !timeSlice) {
+            AccumulationInputs loopInputs;
+            loopInputs.shader = activeShader;
+            loopInputs.width = WINDOW_WIDTH;
+            loopInputs.height = WINDOW_HEIGHT;
+            loopInputs.mouseX = mouseX;
+            loopInputs.mouseY = mouseY;
+            loopInputs.mouseDown = mouseDown;
+            loop = loopPeriods[activeShader] > 0.0f &&
+                   loopCache.begin(loopInputs, loopPeriods[activeShader], clockSeconds);
+        }
+        if (timeSlice || loop) {
+            degradeLevel = DEGRADE_NONE;
+            probe = false;
+        }
+        // The watchdog and F8 force the lowest level, otherwise the governor picks one;
+        // until a variant is compiled the shader keeps the full-quality program
+        ShaderManager& activeManager = shaderManagers[activeShader];
+        const std::vector<ShaderDefines>& levels = qualityLevels[activeShader];
+        int levelCount = static_cast<int>(levels.size());
+        int qualityLevel = 0;
+        if (degradeLevel >= DEGRADE_LOW_QUALITY || forceLowQuality) {
+            qualityLevel = levelCount - 1;
+        } else {
+            qualityLevel = governor.getLevel(SHADER_NAMES[activeShader], qualityLevelKeys[activeShader],
+                                             WINDOW_WIDTH * WINDOW_HEIGHT);
+        }
+        if (qualityLevel > 0 && !activeManager.selectVariant(levels[qualityLevel])) {
+            qualityLevel = 0;
+        }
+        if (qualityLevel == 0) {
+            activeManager.selectVariant(ShaderDefines());
+        }
+        bool useLowQuality = qualityLevel > 0 && qualityLevel == levelCount - 1;
+        // Accumulated frames take one sample per pixel: shaders that supersample
+        // themselves switch to their single-sample variant once it is compiled
+        bool accumulate = accumulator.isEnabled() && degradeLevel == DEGRADE_NONE && !probe && !timeSlice && !loop;
+        if (accumulate && qualityLevel == 0 && !SHADER_SINGLE_SAMPLE_DEFINES[activeShader].empty()) {
+            activeManager.selectVariant(SHADER_SINGLE_SAMPLE_DEFINES[activeShader]);
+        }
+
+        // Internal render size; iResolution and iMouse follow it
+        float renderScale = dynamicResolution.getScale();
+        if (degradeLevel >= DEGRADE_RENDER_SCALE) {
+            renderScale = std::min(renderScale, watchdog.getConfig().renderScale);
+            if (degradeLevel >= DEGRADE_LOW_QUALITY && !useLowQuality) {
+                renderScale *= 0.5f;
+            }
+        }
+        int renderWidth = std::max(1, static_cast<int>(WINDOW_WIDTH * renderScale));
+        int renderHeight = std::max(1, static_cast<int>(WINDOW_HEIGHT * renderScale));
+        // Render to the backend's screen unless the watchdog or the dynamic scale redirects the frame
+        glBindFramebuffer(GL_FRAMEBUFFER, backend->getFramebuffer());
+        glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        // Accumulation takes precedence over interleaving; both replace the offscreen path
+        bool interleave = interleaved.getMode() != INTERLEAVE_OFF && !accumulate && degradeLevel == DEGRADE_NONE &&
+                          !probe && !timeSlice && !loop;
+        // Foveation comes next; it draws its own layers at the window size
+        bool foveate = foveated.isEnabled() && !accumulate && !interleave && degradeLevel == DEGRADE_NONE && !probe &&
+                       !timeSlice && !loop;
+        // Time slices cover the window at full resolution, tile by tile, and so do loops
+        if (foveate || timeSlice || loop) {
+            renderWidth = WINDOW_WIDTH;
+            renderHeight = WINDOW_HEIGHT;
+        }
+        bool offscreen = !accumulate && !interleave && !foveate && !timeSlice && !loop &&
+                         (degradeLevel != DEGRADE_NONE || renderWidth != WINDOW_WIDTH || renderHeight != WINDOW_HEIGHT);
+        bool renderShader = degradeLevel != DEGRADE_FROZEN;
+        // Late latch: pick up mouse motion that arrived since the event pump. It runs
+        // before the frame's inputs are fixed, so accumulation, interleaving and iMouse
+        // all see the same mouse. The peeked events stay queued for the next frame, the
+        // tracker ignores them there.
+        if (lateLatch && renderShader && !timeSlice && !loop && activeShader >= 0 && activeShader < NUM_SHADERS) {
+            TRACE_SCOPE("late latch");
+            SDL_PumpEvents();
+            SDL_Event motionEvents[32];
+            int count = SDL_PeepEvents(motionEvents, 32, SDL_PEEKEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+            if (count > 0) {
+                latency.onInput(motionEvents[count - 1].motion.timestamp);
+            }
+            Uint32 buttons = SDL_GetMouseState(&mouseX, &mouseY);
+            mouseDown = (buttons & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
+        }
+        AccumulationInputs inputs;
+        inputs.shader = activeShader;
+        inputs.program = activeManager.getProgramID();
+        inputs.width = renderWidth;
+        inputs.height = renderHeight;
+        // A shader that does not animate is still even while iTime runs
+        inputs.time = activeManager.readsTime() ? time : 0.0f;
+        inputs.mouseX = mouseX;
+        inputs.mouseY = mouseY;
+        inputs.mouseDown = mouseDown;
+        bool stillFrame = inputs == previousInputs;
+        previousInputs = inputs;
+        // The history is only the previous frame if that frame was interleaved too
+        if (interleave && !previousInterleaved) {
+            interleaved.reset();
+        }
+        previousInterleaved = interleave;
+        if (interleave && !interleaved.begin(renderWidth, renderHeight, stillFrame)) {
+            std::cerr << "Interleaved rendering needs two more render targets, disabled" << std::endl;
+            interleaved.setMode(INTERLEAVE_OFF);
+            interleave = false;
+            offscreen = degradeLevel != DEGRADE_NONE || renderWidth != WINDOW_WIDTH || renderHeight != WINDOW_HEIGHT;
+            glBindFramebuffer(GL_FRAMEBUFFER, backend->getFramebuffer());
+            glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+        // Accumulation draws into its history instead, or nothing once it has converged
+        if (accumulate) {
+            renderShader = accumulator.begin(inputs);
+            if (!renderShader && !accumulator.hasHistory()) {
+                std::cerr << "Progressive accumulation needs a float render target, disabled" << std::endl;
+                accumulator.setEnabled(false);
+                accumulate = false;
+                renderShader = true;
+                renderWidth = WINDOW_WIDTH;
+                renderHeight = WINDOW_HEIGHT;
+            }
+        }
+        if (offscreen && renderShader) {
+            if (sceneTarget.getWidth() != renderWidth || sceneTarget.getHeight() != renderHeight) {
+                sceneTargetShader = -1;
+            }
+            if (sceneTarget.resize(renderWidth, renderHeight)) {
+                sceneTarget.bind();
+                sceneTargetShader = activeShader;
+            } else {
+                offscreen = false;
+                renderWidth = WINDOW_WIDTH;
+                renderHeight = WINDOW_HEIGHT;
+            }
+        }
+        int renderMouseX = mouseX * renderWidth / WINDOW_WIDTH;
+        int renderMouseY = mouseY * renderHeight / WINDOW_HEIGHT;
 
         // Clear the screen
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        if (renderShader && !accumulate) {
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
 
         // Use the active shader and set uniforms
-        if (activeShader >= 0 && activeShader < NUM_SHADERS) {
-            shaderManagers[activeShader].use();
-            shaderManagers[activeShader].setupShaderToyUniforms(
-                WINDOW_WIDTH, WINDOW_HEIGHT, time, deltaTime, frame, mouseX, mouseY, mouseDown
+        if (renderShader && !timeSlice && !loop && activeShader >= 0 && activeShader < NUM_SHADERS) {
+            TRACE_SCOPE("uniform setup");
+            activeManager.use();
+            activeManager.setupShaderToyUniforms(
+                renderWidth, renderHeight, time, deltaTime, frame, renderMouseX, renderMouseY, mouseDown
             );
+            activeManager.setupShaderToyJitter(accumulate ? accumulator.getJitterX() : 0.0f,
+                                               accumulate ? accumulator.getJitterY() : 0.0f);
+            float interleaveValues[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            if (interleave) {
+                interleaved.getInterleave(interleaveValues);
+            }
+            activeManager.setupShaderToyInterleave(interleaveValues[0], interleaveValues[1],
+                                                   interleaveValues[2], interleaveValues[3]);
         }
 
         // Draw the quad
-        glBindVertexArray(quadVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        if (renderShader) {
+            TRACE_SCOPE("draw submission");
+            drawTimer.begin();
+            // The prepass uses iInterleave itself and is per frame, not per time slice
+            bool prepass = prepassShaders[activeShader] && !interleave && !timeSlice && !loop;
+            bool bakedSdf = sdfVolumes[activeShader].isValid();
+            if (bakedSdf) {
+                sdfVolumes[activeShader].bind(activeManager);
+            }
+            if (prepass && !depthPrepass.begin(activeManager, quadVAO, renderWidth, renderHeight)) {
+                std::cerr << "The depth prepass needs a float render target, disabled" << std::endl;
+                prepassShaders.assign(NUM_SHADERS, false);
+                prepass = false;
+            }
+            if (loop) {
+                // Only a slot that is not cached yet runs the shader
+                if (!loopCache.render(activeManager, quadVAO, inputs, frame)) {
+                    std::cerr << "The loop cache needs a render target and room for two frames, disabled" << std::endl;
+                    loopCache.setEnabled(false);
+                }
+            } else if (timeSlice) {
+                // The image keeps the mouse and time it started with
+                if (!timeSliced.render(activeManager, quadVAO, inputs, deltaTime, frame)) {
+                    std::cerr << "Time-sliced rendering needs two render targets, disabled" << std::endl;
+                    timeSliced.setBudgetMs(0.0f);
+                }
+            } else if (!foveate || !foveated.render(activeManager, quadVAO, WINDOW_WIDTH, WINDOW_HEIGHT, mouseX, mouseY,
+                                             backend->getFramebuffer())) {
+                glBindVertexArray(quadVAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                glBindVertexArray(0);
+            }
+            if (prepass) {
+                depthPrepass.end(activeManager);
+            }
+            if (bakedSdf) {
+                sdfVolumes[activeShader].unbind(activeManager);
+            }
+            drawTimer.end();
+            if (accumulate) {
+                accumulator.end();
+            }
+        }
+
+        // Upscale the offscreen frame (or re-present the frozen one) to the window
+        if (accumulate) {
+            accumulator.blitToScreen(WINDOW_WIDTH, WINDOW_HEIGHT, backend->getFramebuffer());
+        } else if (interleave) {
+            interleaved.resolve(quadVAO, WINDOW_WIDTH, WINDOW_HEIGHT, backend->getFramebuffer());
+        } else if (loop) {
+            loopCache.present(quadVAO, WINDOW_WIDTH, WINDOW_HEIGHT, backend->getFramebuffer());
+        } else if (timeSlice) {
+            timeSliced.blitToScreen(WINDOW_WIDTH, WINDOW_HEIGHT, backend->getFramebuffer());
+        } else if (offscreen && sceneTargetShader == activeShader) {
+            sceneTarget.blitToScreen(WINDOW_WIDTH, WINDOW_HEIGHT, backend->getFramebuffer());
+        }
+
+        // Capture the finished scene (without the overlay)
+        bool lastFrame = options.frameCount > 0 && frame + 1 >= options.frameCount;
+        if (screenshotRequested) {
+            readback.request(backend->getFramebuffer(), WINDOW_WIDTH, WINDOW_HEIGHT, frame,
+                             "screenshot_" + std::to_string(frame) + ".ppm");
+            screenshotRequested = false;
+        }
+        if (!options.dumpFramesPrefix.empty()) {
+            char dumpPath[32];
+            std::snprintf(dumpPath, sizeof(dumpPath), "_%06d.ppm", frame);
+            readback.request(backend->getFramebuffer(), WINDOW_WIDTH, WINDOW_HEIGHT, frame,
+                             options.dumpFramesPrefix + dumpPath);
+        }
+        if (sharedFrames.isOpen()) {
+            readback.request(backend->getFramebuffer(), WINDOW_WIDTH, WINDOW_HEIGHT, frame, sharedFrameTag);
+        }
+        if (lastFrame && !options.outputPath.empty()) {
+            readback.request(backend->getFramebuffer(), WINDOW_WIDTH, WINDOW_HEIGHT, frame, options.outputPath);
+        }
+
+        // Draw the performance overlay on top
+        std::string hudLabel = getKeyName(activeShader) + " " + SHADER_NAMES[activeShader];
+        if (degradeLevel != DEGRADE_NONE) {
+            hudLabel += std::string(" [") + getDegradeLevelName(degradeLevel) + "]";
+        }
+        else if (qualityLevel > 0) {
+            hudLabel += std::string(" [") + getQualityLevelName(qualityLevel, levelCount) + "]";
+        }
+        if (accumulate) {
+            hudLabel += " [" + std::to_string(accumulator.getSampleCount()) + " spp]";
+        } else if (interleave) {
+            hudLabel += std::string(" [") + getInterleaveModeName(interleaved.getMode()) + "]";
+        } else if (loop) {
+            hudLabel += " [loop " + std::to_string(loopCache.getFramesFilled()) + "/" +
+                        std::to_string(loopCache.getFrameCount()) + "]";
+        } else if (timeSlice) {
+            hudLabel += " [tiles " + std::to_string(timeSliced.getTilesDone()) + "/" +
+                        std::to_string(timeSliced.getTileCount()) + "]";
+        } else if (foveate) {
+            hudLabel += " [foveated -" + std::to_string(static_cast<int>(foveated.getLastSavedFraction() * 100.0f + 0.5f)) +
+                        "% fragments]";
+        }
+        if (dynamicResolution.isEnabled()) {
+            hudLabel += " " + std::to_string(renderWidth) + "x" + std::to_string(renderHeight);
+        }
+        hud.draw(frameStats, hudLabel, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        // CPU time of the frame up to here; present and the finishes below wait for vsync
+        // or the GPU, which says nothing about the shader's cost
+        float submitMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0f / perfFrequency - waitMs;
+
+        // Swap buffers (or flush the offscreen context)
+        backend->present();
+
+        // Hand finished readbacks from earlier frames to the writer thread
+        readback.poll();
+        framePacer.onFrameSubmitted();
 
-        // Swap buffers
-        SDL_GL_SwapWindow(window);
+        // In latency mode wait for the swap to execute so the sample covers
+        // the whole path to presentation
+        if (latency.isEnabled()) {
+            TRACE_SCOPE("present wait");
+            glFinish();
+            latency.onFramePresented();
+        }
+
+        // Collect GPU timings from earlier frames
+        drawTimer.resolve();
+
+        // Advance the background variant compiles, the active shader's first
+        bool variantStarted = shaderManagers[activeShader].pollVariants();
+        for (int i = 0; i < NUM_SHADERS; i++) {
+            if (i != activeShader && shaderManagers[i].pollVariants(!variantStarted)) {
+                variantStarted = true;
+            }
+        }
+
+        // A probe waits for the GPU so its cost is exact
+        if (probe) {
+            TRACE_SCOPE("watchdog probe");
+            glFinish();
+        }
+
+        // Record frame timings (the first interval includes startup, skip it)
+        if (frame > 0) {
+            float cpuMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0f / perfFrequency - waitMs;
+            frameStats.addFrame(frameMs, cpuMs, drawTimer.getLastMs(), waitMs);
+            if (renderShader && !timeSlice && !loop) {
+                float costMs = probe ? cpuMs : std::max(cpuMs, drawTimer.getLastMs());
+                watchdog.reportFrame(activeShader, SHADER_NAMES[activeShader], degradeLevel, probe, costMs, clockSeconds);
+                // Accumulated frames are single-sample, they say nothing about the full cost
+                if (degradeLevel == DEGRADE_NONE && !probe && !accumulate && !foveate) {
+                    // Both controllers follow the cost of the draw alone
+                    float drawMs = drawTimer.isSupported() ? drawTimer.getLastMs() : submitMs;
+                    dynamicResolution.reportFrame(drawMs);
+                    if (!interleave) {
+                        governor.reportFrame(SHADER_NAMES[activeShader], qualityLevelKeys[activeShader], qualityLevel,
+                                             drawMs, renderWidth * renderHeight, WINDOW_WIDTH * WINDOW_HEIGHT);
+                    }
+                }
+            }
+        }
 
         // Increment frame counter
         frame++;
+        if (lastFrame) {
+            quit = true;
+        }
 
         // Add a small delay to reduce CPU usage
-        SDL_Delay(16); // ~60 FPS
+        if (!headless) {
+            TRACE_SCOPE("frame delay");
+            SDL_Delay(16); // ~60 FPS
+        }
+    }
+
+    // Write out the remaining captures
+    readback.finish();
+    if (framesDumped > 0) {
+        std::cout << framesDumped << " frames dumped to " << options.dumpFramesPrefix << "_*.ppm (render thread stalled "
+                  << readback.getStallMs() << " ms in total)" << std::endl;
+    }
+    if (sharedFrames.isOpen()) {
+        std::cout << sharedFrames.getPublished() << " frames published to " << options.sharedMemoryName;
+        if (sharedFrames.getSkipped() > 0) {
+            std::cout << " (" << sharedFrames.getSkipped() << " larger than the --size slots skipped)";
+        }
+        std::cout << std::endl;
+        sharedFrames.close();
+    }
+
+    if (foveated.getFullFragments() > 0) {
+        std::cout << "Foveated rendering shaded " << foveated.getShadedFragments() << " of "
+                  << foveated.getFullFragments() << " fragments ("
+                  << 100.0 * (foveated.getFullFragments() - foveated.getShadedFragments()) / foveated.getFullFragments()
+                  << "% saved)" << std::endl;
+    }
+
+    if (loopCache.getFramesPlayed() > 0 || loopCache.getFramesFilled() > 0) {
+        std::cout << "Loop cache played " << loopCache.getFramesPlayed() << " frames, holds "
+                  << loopCache.getFramesFilled() << "/" << loopCache.getFrameCount() << " ("
+                  << loopCache.getBytes() / 1024 << " KB " << (loopCache.isCompressed() ? "DXT1" : "RGB5") << "), "
+                  << loopCache.getInvalidations() << " invalidations" << std::endl;
+    }
+    if (timeSliced.getImagesCompleted() > 0) {
+        std::cout << "Time-sliced rendering completed " << timeSliced.getImagesCompleted() << " images, the last in "
+                  << timeSliced.getLastImageSeconds() << " s (" << timeSliced.getTileSize() << " px tiles, "
+                  << timeSliced.getBudgetMs() << " ms per frame)" << std::endl;
+    }
+
+    // Keep the variant costs measured on this machine for the next launch
+    if (governor.isEnabled()) {
+        governor.save(qualityCachePath);
+    }
+
+    // Report the latency distribution of this run
+    if (latency.isEnabled()) {
+        latency.printReport();
+    }
+
+    // Write the trace recorded during this run
+    if (traceIsEnabled()) {
+        traceWriteJson(options.tracePath);
     }
 
     // Clean up
     glDeleteVertexArrays(1, &quadVAO);
-    SDL_GL_DeleteContext(glContext);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
     return 0;
 }
\ No newline at end of file
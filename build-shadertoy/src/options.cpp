@@ -0,0 +1,329 @@
+#include "../include/options.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "  --trace <file>    Record frame phases and write a Chrome trace to <file> on exit" << std::endl;
+    std::cout << "  --hud             Start with the performance overlay visible (toggle with F1)" << std::endl;
+    std::cout << "  --latency         Measure input-to-present latency (adds a glFinish after each swap)" << std::endl;
+    std::cout << "  --late-latch      Resample the mouse right before the draw call (toggle with F4)" << std::endl;
+    std::cout << "  --no-watchdog     Never degrade slow shaders (toggle with F5)" << std::endl;
+    std::cout << "  --frame-budget <ms>   Frame cost that counts as too slow for the watchdog (default 100)" << std::endl;
+    std::cout << "  --budget-frames <n>   Consecutive slow frames before the watchdog steps down (default 5)" << std::endl;
+    std::cout << "  --low-quality         Start with the low-quality shader variants (toggle with F8)" << std::endl;
+    std::cout << "  --quality-governor    Pick the best shader variant that holds --target-fps, remembered per machine (toggle with F9)" << std::endl;
+    std::cout << "  --accumulate <n>      Accumulate still views progressively up to n samples per pixel (toggle with F10)" << std::endl;
+    std::cout << "  --paused              Start with iTime paused (toggle with Space)" << std::endl;
+    std::cout << "  --interleave <mode>   Shade off, checkerboard (half) or quarter of the pixels per frame (cycle with F11)" << std::endl;
+    std::cout << "  --foveate <radius>    Full resolution within radius pixels of the mouse, less outside (toggle with F12)" << std::endl;
+    std::cout << "  --foveate-falloff <px>  Width of the blend rings around the full-resolution area (default 100)" << std::endl;
+    std::cout << "  --time-slice <ms>     Render every shader in tiles, <ms> of them per frame (waiting for each tile); the image shows when complete" << std::endl;
+    std::cout << "  --depth-prepass <n>   Ray marchers with the prepass hook start from an n x n pixel block cone march (e.g. 8)" << std::endl;
+    std::cout << "  --baked-sdf           Static distance functions step through a baked volume far from surfaces (see shader_sdfbake)" << std::endl;
+    std::cout << "  --loop-cache <s|auto> Play periodic shaders back from cached frames after the first loop (auto: declared or probed period)" << std::endl;
+    std::cout << "  --loop-fps <n>        Cached frames per second of the loop (default 30)" << std::endl;
+    std::cout << "  --loop-budget <MB>    Texture memory for the cached frames, fewer per second if a loop needs more (default 256)" << std::endl;
+    std::cout << "  --dynamic-resolution  Scale the render resolution to hold --target-fps (toggle with F7)" << std::endl;
+    std::cout << "  --target-fps <n>      Frame rate dynamic resolution and the quality governor aim for (default 60)" << std::endl;
+    std::cout << "  --min-scale <f>       Lowest dynamic render scale per axis, 0.05-1 (default 0.25)" << std::endl;
+    std::cout << "  --frames-in-flight <n>  Frames the driver may queue ahead, 1-3 (default 2)" << std::endl;
+    std::cout << "  --backend <name>  Rendering backend: window (default), egl or osmesa" << std::endl;
+    std::cout << "  --headless        Shorthand for --backend egl" << std::endl;
+    std::cout << "  --size <WxH>      Window or offscreen size (default 1440x720)" << std::endl;
+    std::cout << "  --shader <n>      Start with shader n (1-based)" << std::endl;
+    std::cout << "  --frames <n>      Quit after n frames (offscreen default 1, 0 = run until quit)" << std::endl;
+    std::cout << "  --output <file>   Write the last frame to <file> as PPM" << std::endl;
+    std::cout << "  --dump-frames <prefix>  Write every frame to <prefix>_NNNNNN.ppm (F6 saves a single screenshot)" << std::endl;
+    std::cout << "  --shm-output <name>   Publish every frame to a shared-memory ring (e.g. /shadertoy_frames)" << std::endl;
+    std::cout << "  --export <file|->     Render --shader at --size with a fixed clock and stream it as video, then quit" << std::endl;
+    std::cout << "  --export-format <f>   y4m (default) or raw rgb24" << std::endl;
+    std::cout << "  --fps <n>             Export frame rate (default 60)" << std::endl;
+    std::cout << "  --duration <s>        Export length in seconds (default 10)" << std::endl;
+    std::cout << "  --workers <n>         Export on n offscreen contexts, one thread each (default 1)" << std::endl;
+    std::cout << "  --scaling             Time the export with 1, 2, 4 ... n contexts and report the efficiency" << std::endl;
+    std::cout << "  --poster <file>       Render --shader at --size (may exceed the GPU limit) in tiles to a PPM, then quit" << std::endl;
+    std::cout << "  --tile-size <n>       Poster tile edge in pixels (default 2048)" << std::endl;
+    std::cout << "  --poster-time <s>     iTime of the poster (default 10)" << std::endl;
+    std::cout << "  --help            Show this message" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], RenderOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        // Returns the value following the current flag, or nullptr if missing
+        auto nextValue = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--trace") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.tracePath = value;
+        }
+        else if (arg == "--hud") {
+            options.showHud = true;
+        }
+        else if (arg == "--latency") {
+            options.measureLatency = true;
+        }
+        else if (arg == "--late-latch") {
+            options.lateLatch = true;
+        }
+        else if (arg == "--no-watchdog") {
+            options.watchdog = false;
+        }
+        else if (arg == "--frame-budget" || arg == "--budget-frames") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--frame-budget") {
+                options.frameBudgetMs = std::max(1.0f, static_cast<float>(std::atof(value)));
+            } else {
+                options.budgetFrames = std::max(1, std::atoi(value));
+            }
+        }
+        else if (arg == "--frames-in-flight") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.framesInFlight = std::atoi(value);
+            if (options.framesInFlight < 1 || options.framesInFlight > 3) {
+                std::cerr << "--frames-in-flight must be between 1 and 3" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--backend") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (!parseBackendType(value, options.backend)) {
+                std::cerr << "Unknown backend: " << value << " (expected window, egl or osmesa)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--headless") {
+            options.backend = BACKEND_EGL;
+        }
+        else if (arg == "--size") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2 ||
+                options.width < 1 || options.height < 1) {
+                std::cerr << "--size expects WIDTHxHEIGHT, e.g. 1920x1080" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--shader" || arg == "--frames") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--shader") {
+                options.startShader = std::max(1, std::atoi(value)) - 1;
+            } else {
+                options.frameCount = std::max(0, std::atoi(value));
+            }
+        }
+        else if (arg == "--output" || arg == "--dump-frames") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--output") {
+                options.outputPath = value;
+            } else {
+                options.dumpFramesPrefix = value;
+            }
+        }
+        else if (arg == "--low-quality") {
+            options.lowQuality = true;
+        }
+        else if (arg == "--quality-governor") {
+            options.qualityGovernor = true;
+        }
+        else if (arg == "--accumulate") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.accumulateSamples = std::max(0, std::atoi(value));
+        }
+        else if (arg == "--paused") {
+            options.paused = true;
+        }
+        else if (arg == "--interleave") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (!parseInterleaveMode(value, options.interleaveMode)) {
+                std::cerr << "Unknown interleave mode: " << value << " (expected off, checkerboard or quarter)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--foveate" || arg == "--foveate-falloff") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            float pixels = std::max(0.0f, static_cast<float>(std::atof(value)));
+            if (arg == "--foveate") {
+                options.foveaRadius = pixels;
+            } else {
+                options.foveaFalloff = pixels;
+            }
+        }
+        else if (arg == "--time-slice") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.timeSliceMs = std::max(0.0f, static_cast<float>(std::atof(value)));
+        }
+        else if (arg == "--depth-prepass") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.prepassBlock = std::max(0, std::atoi(value));
+        }
+        else if (arg == "--baked-sdf") {
+            options.bakedSdf = true;
+        }
+        else if (arg == "--loop-cache") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.loopPeriod = std::string(value) == "auto" ? -1.0f
+                                                              : std::max(0.0f, static_cast<float>(std::atof(value)));
+        }
+        else if (arg == "--loop-fps" || arg == "--loop-budget") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--loop-fps") {
+                options.loopFps = std::max(1.0f, static_cast<float>(std::atof(value)));
+            } else {
+                options.loopBudgetMb = std::max(1, std::atoi(value));
+            }
+        }
+        else if (arg == "--dynamic-resolution") {
+            options.dynamicResolution = true;
+        }
+        else if (arg == "--target-fps" || arg == "--min-scale") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--target-fps") {
+                options.targetFps = std::max(1.0f, static_cast<float>(std::atof(value)));
+            } else {
+                options.minRenderScale = std::max(0.05f, std::min(1.0f, static_cast<float>(std::atof(value))));
+            }
+        }
+        else if (arg == "--shm-output") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            // POSIX object names start with a slash
+            options.sharedMemoryName = value[0] == '/' ? value : std::string("/") + value;
+        }
+        else if (arg == "--export" || arg == "--export-format" || arg == "--fps" || arg == "--duration") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--export") {
+                options.exportPath = value;
+            } else if (arg == "--export-format") {
+                if (!parseVideoFormat(value, options.exportFormat)) {
+                    std::cerr << "Unknown export format: " << value << " (expected y4m or raw)" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--fps") {
+                options.exportFps = std::max(1, std::atoi(value));
+            } else {
+                options.exportSeconds = std::max(0.0f, static_cast<float>(std::atof(value)));
+            }
+        }
+        else if (arg == "--workers") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            options.exportWorkers = std::max(1, std::atoi(value));
+        }
+        else if (arg == "--scaling") {
+            options.exportScaling = true;
+        }
+        else if (arg == "--poster" || arg == "--tile-size" || arg == "--poster-time") {
+            const char* value = nextValue();
+            if (!value) {
+                printUsage(argv[0]);
+                return false;
+            }
+            if (arg == "--poster") {
+                options.posterPath = value;
+            } else if (arg == "--tile-size") {
+                options.tileSize = std::max(16, std::atoi(value));
+            } else {
+                options.posterTime = static_cast<float>(std::atof(value));
+            }
+        }
+        else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return false;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    // Worker contexts are offscreen contexts of the same kind
+    if ((options.exportWorkers > 1 || options.exportScaling) && options.backend == BACKEND_WINDOW) {
+        std::cerr << "--workers / --scaling need an offscreen backend (--headless)" << std::endl;
+        return false;
+    }
+
+    // An offscreen run renders a single frame unless told otherwise
+    if (options.frameCount < 0) {
+        options.frameCount = options.backend == BACKEND_WINDOW ? 0 : 1;
+    }
+    return true;
+}
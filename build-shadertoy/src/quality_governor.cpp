@@ -0,0 +1,181 @@
+#include "../include/quality_governor.h"
+#include "../include/file_io.h"
+#include "../include/gpu_timer.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Frames ignored after a level change: GPU timings arrive a few frames late
+const int QUALITY_GOVERNOR_SETTLE_FRAMES = GPU_TIMER_RING_SIZE + 2;
+
+// Weight of the newest frame in a variant's cost
+const float QUALITY_GOVERNOR_SMOOTHING = 0.1f;
+
+// File layout, one line per variant measured on a machine (tab separated):
+//   machine, shader name, variant define key ("-" for the source as written),
+//   milliseconds per megapixel, frames measured
+
+std::string getQualityMachineKey() {
+    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    std::string key = std::string(vendor ? vendor : "?") + " / " + (renderer ? renderer : "?") + " / " +
+                      (version ? version : "?");
+    // Tabs and newlines separate the file's fields
+    for (char& c : key) {
+        if (c == '\t' || c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return key;
+}
+
+const char* getQualityLevelName(int level, int levelCount) {
+    if (level <= 0) {
+        return "full quality";
+    }
+    return level >= levelCount - 1 ? "low quality" : "medium quality";
+}
+
+QualityGovernor::QualityGovernor() : enabled(false) {
+}
+
+bool QualityGovernor::load(const std::string& filePath, const std::string& machineKey) {
+    machine = machineKey;
+    costs.clear();
+    otherMachineLines.clear();
+    std::ifstream file(filePath);
+    if (!file) {
+        return true;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        for (size_t tab = line.find('\t'); tab != std::string::npos; tab = line.find('\t', start)) {
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+        fields.push_back(line.substr(start));
+        if (fields.size() != 5) {
+            continue;
+        }
+        if (fields[0] != machine) {
+            otherMachineLines.push_back(line);
+            continue;
+        }
+        Measurement measurement;
+        measurement.msPerMegapixel = static_cast<float>(std::atof(fields[3].c_str()));
+        measurement.samples = std::atoi(fields[4].c_str());
+        if (measurement.msPerMegapixel > 0.0f && measurement.samples > 0) {
+            costs[fields[1] + "\t" + (fields[2] == "-" ? "" : fields[2])] = measurement;
+        }
+    }
+    std::cout << "Quality governor: " << costs.size() << " measured variants for " << machine << std::endl;
+    return true;
+}
+
+bool QualityGovernor::save(const std::string& filePath) const {
+    return saveFileAtomically(filePath, "QUALITY_GOVERNOR", "w", [this](std::FILE* file) {
+        for (const std::string& line : otherMachineLines) {
+            std::fprintf(file, "%s\n", line.c_str());
+        }
+        for (const auto& entry : costs) {
+            size_t tab = entry.first.find('\t');
+            std::string levelKey = entry.first.substr(tab + 1);
+            std::fprintf(file, "%s\t%s\t%s\t%.6g\t%d\n", machine.c_str(), entry.first.substr(0, tab).c_str(),
+                         levelKey.empty() ? "-" : levelKey.c_str(), entry.second.msPerMegapixel, entry.second.samples);
+        }
+    });
+}
+
+const QualityGovernor::Measurement* QualityGovernor::findCost(const std::string& shaderName,
+                                                            const std::string& levelKey) const {
+    std::map<std::string, Measurement>::const_iterator entry = costs.find(shaderName + "\t" + levelKey);
+    return entry == costs.end() ? nullptr : &entry->second;
+}
+
+int QualityGovernor::pickLevel(const std::string& shaderName, const std::vector<std::string>& levelKeys,
+                               int windowPixels) const {
+    // The highest level known to fit, or the highest one not measured yet
+    float megapixels = windowPixels / 1.0e6f;
+    for (size_t level = 0; level < levelKeys.size(); level++) {
+        const Measurement* cost = findCost(shaderName, levelKeys[level]);
+        if (!cost || cost->msPerMegapixel * megapixels <= config.budgetMs) {
+            return static_cast<int>(level);
+        }
+    }
+    return static_cast<int>(levelKeys.size()) - 1;
+}
+
+int QualityGovernor::getLevel(const std::string& shaderName, const std::vector<std::string>& levelKeys,
+                              int windowPixels) {
+    if (!enabled || levelKeys.size() < 2) {
+        return 0;
+    }
+    ShaderState& state = states[shaderName];
+    if (state.level < 0 || state.level >= static_cast<int>(levelKeys.size())) {
+        state.level = pickLevel(shaderName, levelKeys, windowPixels);
+        state.frames = 0;
+        state.settleFrames = QUALITY_GOVERNOR_SETTLE_FRAMES;
+        std::cout << "Quality governor: " << shaderName << " starts at "
+                  << getQualityLevelName(state.level, static_cast<int>(levelKeys.size())) << std::endl;
+    }
+    return state.level;
+}
+
+void QualityGovernor::reportFrame(const std::string& shaderName, const std::vector<std::string>& levelKeys,
+                                  int level, float costMs, int renderPixels, int windowPixels) {
+    if (!enabled || levelKeys.size() < 2 || costMs <= 0.0f || renderPixels <= 0) {
+        return;
+    }
+    ShaderState& state = states[shaderName];
+    if (level != state.level) {
+        return;
+    }
+    if (state.settleFrames > 0) {
+        state.settleFrames--;
+        return;
+    }
+
+    // Costs from earlier runs are refined, a first measurement is taken as is
+    float msPerMegapixel = costMs / (renderPixels / 1.0e6f);
+    Measurement& cost = costs[shaderName + "\t" + levelKeys[level]];
+    if (cost.samples <= 0) {
+        cost.msPerMegapixel = msPerMegapixel;
+        cost.samples = 0;
+    } else {
+        cost.msPerMegapixel += (msPerMegapixel - cost.msPerMegapixel) * QUALITY_GOVERNOR_SMOOTHING;
+    }
+    cost.samples++;
+    if (++state.frames < config.sampleFrames) {
+        return;
+    }
+    state.frames = 0;
+
+    float megapixels = windowPixels / 1.0e6f;
+    int levelCount = static_cast<int>(levelKeys.size());
+    int newLevel = level;
+    if (cost.msPerMegapixel * megapixels > config.budgetMs && level + 1 < levelCount) {
+        newLevel = level + 1;
+    } else if (level > 0) {
+        const Measurement* higher = findCost(shaderName, levelKeys[level - 1]);
+        if (!higher || higher->msPerMegapixel * megapixels < config.budgetMs * (1.0f - config.hysteresis)) {
+            newLevel = level - 1;
+        }
+    }
+    if (newLevel != level) {
+        std::cout << "Quality governor: " << shaderName << " " << getQualityLevelName(level, levelCount) << " -> "
+                  << getQualityLevelName(newLevel, levelCount) << " (" << cost.msPerMegapixel * megapixels
+                  << " ms at the window size vs budget " << config.budgetMs << " ms)" << std::endl;
+        state.level = newLevel;
+        state.settleFrames = QUALITY_GOVERNOR_SETTLE_FRAMES;
+    }
+}
+
+void QualityGovernor::reset(const std::string& shaderName) {
+    std::map<std::string, ShaderState>::iterator state = states.find(shaderName);
+    if (state != states.end()) {
+        state->second.frames = 0;
+        state->second.settleFrames = QUALITY_GOVERNOR_SETTLE_FRAMES;
+    }
+}
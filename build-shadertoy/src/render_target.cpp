@@ -0,0 +1,68 @@
+#include "../include/render_target.h"
+
+RenderTarget::RenderTarget() : framebuffer(0), texture(0), width(0), height(0), internalFormat(GL_RGBA8) {
+}
+
+RenderTarget::~RenderTarget() {
+    release();
+}
+
+void RenderTarget::release() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    width = height = 0;
+}
+
+bool RenderTarget::resize(int newWidth, int newHeight, GLenum newInternalFormat) {
+    if (framebuffer != 0 && newWidth == width && newHeight == height && newInternalFormat == internalFormat) {
+        return true;
+    }
+    release();
+    width = newWidth > 0 ? newWidth : 1;
+    height = newHeight > 0 ? newHeight : 1;
+    internalFormat = newInternalFormat;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    bool floatFormat = internalFormat == GL_RGBA16F || internalFormat == GL_RGBA32F || internalFormat == GL_RG32F ||
+                       internalFormat == GL_R32F;
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA,
+                 floatFormat ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::FRAMEBUFFER::INCOMPLETE: status 0x" << std::hex << status << std::dec
+                  << " for " << width << "x" << height << std::endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void RenderTarget::blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, screenFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glViewport(0, 0, windowWidth, windowHeight);
+}
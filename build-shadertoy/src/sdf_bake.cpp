@@ -0,0 +1,263 @@
+#include "../include/sdf_bake.h"
+#include "../include/file_io.h"
+#include "../include/render_target.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// File layout (little-endian, as written by the host):
+//   char[8]  "STSDFVOL"
+//   uint32   version
+//   uint64   source hash
+//   float    bounds min[3], bounds max[3] (as requested)
+//   int32    resolution
+//   uint32   size[3]
+//   float    voxel size
+//   float    distances, size[0] * size[1] * size[2]
+static const char SDF_VOLUME_MAGIC[8] = {'S', 'T', 'S', 'D', 'F', 'V', 'O', 'L'};
+
+// Upper limit of the samples along the longest side (512^3 floats are half a gigabyte)
+const int SDF_BAKE_MAX_RESOLUTION = 512;
+
+// Main of the bake program: one fragment per node of the slice
+static const char* sdfBakeMainSource = R"(
+        uniform vec3 uBoundsMin;
+        uniform float uVoxelSize;
+        uniform float uSlice;
+
+        void main() {
+            vec3 node = vec3(floor(gl_FragCoord.xy), uSlice);
+            fragColor = vec4(SHADERTOY_STATIC_SDF(uBoundsMin + node * uVoxelSize), 0.0, 0.0, 1.0);
+        }
+)";
+
+bool SdfBakeSettings::operator==(const SdfBakeSettings& other) const {
+    for (int axis = 0; axis < 3; axis++) {
+        if (boundsMin[axis] != other.boundsMin[axis] || boundsMax[axis] != other.boundsMax[axis]) {
+            return false;
+        }
+    }
+    return resolution == other.resolution;
+}
+
+bool shaderHasStaticSdf(const std::string& shaderToyCode) {
+    return shaderToyCode.find("SHADERTOY_STATIC_SDF") != std::string::npos;
+}
+
+bool parseSdfBounds(const std::string& shaderToyCode, SdfBakeSettings& settings) {
+    const std::string directive = "// sdf-bounds:";
+    size_t start = shaderToyCode.find(directive);
+    if (start == std::string::npos) {
+        return false;
+    }
+    size_t end = shaderToyCode.find('\n', start);
+    std::istringstream line(shaderToyCode.substr(start + directive.size(), end - start - directive.size()));
+    float bounds[6];
+    for (float& value : bounds) {
+        if (!(line >> value)) {
+            return false;
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        if (bounds[axis + 3] <= bounds[axis]) {
+            return false;
+        }
+    }
+    std::copy(bounds, bounds + 3, settings.boundsMin);
+    std::copy(bounds + 3, bounds + 6, settings.boundsMax);
+    return true;
+}
+
+std::string getSdfCachePath(const std::string& cacheDir, const std::string& name) {
+    return cacheDir + "/" + name + ".sdf.cache";
+}
+
+bool bakeSdfVolume(const std::string& shaderToyCode, const SdfBakeSettings& settings, GLuint quadVAO,
+                   SdfVolume& volume) {
+    TRACE_SCOPE("sdf bake");
+    if (!shaderHasStaticSdf(shaderToyCode)) {
+        std::cerr << "ERROR::SDF_BAKE::NO_STATIC_SDF: the shader does not define SHADERTOY_STATIC_SDF(p)" << std::endl;
+        return false;
+    }
+    // Cubic cells, so the sampling error is the same in every direction
+    int resolution = std::max(2, std::min(SDF_BAKE_MAX_RESOLUTION, settings.resolution));
+    float longest = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        longest = std::max(longest, settings.boundsMax[axis] - settings.boundsMin[axis]);
+    }
+    if (longest <= 0.0f) {
+        std::cerr << "ERROR::SDF_BAKE::EMPTY_BOUNDS" << std::endl;
+        return false;
+    }
+    volume.settings = settings;
+    volume.sourceHash = hashSource(shaderToyCode);
+    volume.voxelSize = longest / (resolution - 1);
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = settings.boundsMax[axis] - settings.boundsMin[axis];
+        volume.size[axis] = std::max(2, static_cast<int>(std::ceil(extent / volume.voxelSize - 1e-3f)) + 1);
+    }
+
+    ShaderManager shader;
+    if (!shader.loadFromStrings(defaultVertexShader,
+                                createShaderToyFragmentShader(shaderToyCode, ShaderDefines(), sdfBakeMainSource))) {
+        std::cerr << "ERROR::SDF_BAKE::COMPILE_FAILED" << std::endl;
+        return false;
+    }
+
+    FramebufferScope binding;
+    RenderTarget slice;
+    bool ok = slice.resize(volume.size[0], volume.size[1], GL_R32F);
+    if (ok) {
+        size_t sliceSize = static_cast<size_t>(volume.size[0]) * volume.size[1];
+        volume.distances.resize(sliceSize * volume.size[2]);
+        slice.bind();
+        shader.use();
+        shader.setupShaderToyUniforms(volume.size[0], volume.size[1], 0.0f, 0.0f, 0, 0, 0, false);
+        shader.setVec3("uBoundsMin", settings.boundsMin[0], settings.boundsMin[1], settings.boundsMin[2]);
+        shader.setFloat("uVoxelSize", volume.voxelSize);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindVertexArray(quadVAO);
+        for (int z = 0; z < volume.size[2]; z++) {
+            shader.setFloat("uSlice", static_cast<float>(z));
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            glReadPixels(0, 0, volume.size[0], volume.size[1], GL_RED, GL_FLOAT, &volume.distances[sliceSize * z]);
+        }
+        glBindVertexArray(0);
+        ok = glGetError() == GL_NO_ERROR;
+    }
+    if (!ok) {
+        std::cerr << "ERROR::SDF_BAKE::RENDER_FAILED" << std::endl;
+        volume.distances.clear();
+    }
+    return ok;
+}
+
+bool saveSdfVolume(const std::string& filePath, const SdfVolume& volume) {
+    return saveFileAtomically(filePath, "SDF_BAKE", "wb", [&volume](std::FILE* file) {
+        std::fwrite(SDF_VOLUME_MAGIC, 1, sizeof(SDF_VOLUME_MAGIC), file);
+        writeValue(file, SDF_BAKE_VERSION);
+        writeValue(file, volume.sourceHash);
+        std::fwrite(volume.settings.boundsMin, sizeof(float), 3, file);
+        std::fwrite(volume.settings.boundsMax, sizeof(float), 3, file);
+        writeValue(file, static_cast<int32_t>(volume.settings.resolution));
+        for (int axis = 0; axis < 3; axis++) {
+            writeValue(file, static_cast<uint32_t>(volume.size[axis]));
+        }
+        writeValue(file, volume.voxelSize);
+        std::fwrite(volume.distances.data(), sizeof(float), volume.distances.size(), file);
+    });
+}
+
+bool loadSdfVolume(const std::string& filePath, uint64_t sourceHash, SdfVolume& volume) {
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[8];
+    uint32_t version = 0;
+    int32_t resolution = 0;
+    uint32_t size[3] = {0, 0, 0};
+    bool ok = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+              std::memcmp(magic, SDF_VOLUME_MAGIC, sizeof(magic)) == 0 &&
+              readValue(file, version) && version == SDF_BAKE_VERSION && readValue(file, volume.sourceHash);
+    // A bake of another source is stale, not damaged
+    bool current = ok && volume.sourceHash == sourceHash;
+    ok = current && std::fread(volume.settings.boundsMin, sizeof(float), 3, file) == 3 &&
+         std::fread(volume.settings.boundsMax, sizeof(float), 3, file) == 3 && readValue(file, resolution) &&
+         readValue(file, size[0]) && readValue(file, size[1]) && readValue(file, size[2]) &&
+         readValue(file, volume.voxelSize);
+    for (int axis = 0; ok && axis < 3; axis++) {
+        ok = size[axis] >= 2 && size[axis] <= static_cast<uint32_t>(SDF_BAKE_MAX_RESOLUTION);
+        volume.size[axis] = static_cast<int>(size[axis]);
+    }
+    if (ok) {
+        volume.settings.resolution = resolution;
+        volume.distances.resize(static_cast<size_t>(size[0]) * size[1] * size[2]);
+        ok = std::fread(volume.distances.data(), sizeof(float), volume.distances.size(), file) ==
+             volume.distances.size();
+    }
+    std::fclose(file);
+    if (current && !ok) {
+        std::cerr << "ERROR::SDF_BAKE::BAD_CACHE (rebaking): " << filePath << std::endl;
+    }
+    if (!ok) {
+        volume.distances.clear();
+    }
+    return ok;
+}
+
+bool loadOrBakeSdfVolume(const std::string& filePath, const std::string& shaderToyCode,
+                         const SdfBakeSettings& settings, GLuint quadVAO, SdfVolume& volume) {
+    if (loadSdfVolume(filePath, hashSource(shaderToyCode), volume)) {
+        return true;
+    }
+    if (!bakeSdfVolume(shaderToyCode, settings, quadVAO, volume)) {
+        return false;
+    }
+    // A bake that cannot be stored still serves this run
+    saveSdfVolume(filePath, volume);
+    return true;
+}
+
+SdfVolumeTexture::SdfVolumeTexture() : texture(0), boundsMin{0.0f, 0.0f, 0.0f}, boundsMax{0.0f, 0.0f, 0.0f},
+                                       error(0.0f) {
+}
+
+SdfVolumeTexture::~SdfVolumeTexture() {
+    release();
+}
+
+bool SdfVolumeTexture::upload(const SdfVolume& volume) {
+    release();
+    if (volume.distances.empty()) {
+        return false;
+    }
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, volume.size[0], volume.size[1], volume.size[2], 0, GL_RED, GL_FLOAT,
+                 volume.distances.data());
+    // Trilinear between the nodes; clamped, though the wrapper never samples outside
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "ERROR::SDF_BAKE::UPLOAD_FAILED" << std::endl;
+        release();
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        boundsMin[axis] = volume.settings.boundsMin[axis];
+        boundsMax[axis] = boundsMin[axis] + (volume.size[axis] - 1) * volume.voxelSize;
+    }
+    // An SDF changes by at most the distance moved, and a trilinear sample mixes nodes
+    // no further than a cell diagonal away
+    error = volume.voxelSize * std::sqrt(3.0f);
+    return true;
+}
+
+void SdfVolumeTexture::bind(ShaderManager& shader) const {
+    glActiveTexture(GL_TEXTURE0 + SHADERTOY_SDF_VOLUME_UNIT);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setupShaderToySdfVolume(isValid(), boundsMin, boundsMax, error);
+}
+
+void SdfVolumeTexture::unbind(ShaderManager& shader) const {
+    shader.setupShaderToySdfVolume(false, boundsMin, boundsMax, error);
+    glActiveTexture(GL_TEXTURE0 + SHADERTOY_SDF_VOLUME_UNIT);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void SdfVolumeTexture::release() {
+    if (texture) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
@@ -0,0 +1,351 @@
+// shader_bench: renders every shader in ../shaders at fixed iTime values and a set of
+// resolutions, and writes compile/link time and frame-time percentiles as JSON.
+// Runs unattended on the headless backends (software GL on a GPU-less box works).
+#include "../include/shader_manager.h"
+#include "../include/includes.h"
+#include "../include/backend.h"
+#include "../include/depth_prepass.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+// iTime values the measured frames cycle through
+const float BENCH_TIMES[] = {1.0f, 2.5f, 5.0f, 10.0f};
+const int BENCH_TIME_COUNT = sizeof(BENCH_TIMES) / sizeof(BENCH_TIMES[0]);
+
+struct BenchResolution {
+    int width;
+    int height;
+};
+
+struct BenchOptions {
+    BackendType backend = BACKEND_EGL;
+    std::string shaderDir = "../shaders";
+    std::string outputPath = "shader_bench.json";
+    std::vector<BenchResolution> resolutions = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+    int warmupFrames = 3;
+    int measuredFrames = 20;
+    // Stop measuring a shader/resolution pair after this long (keeps software GL runs bounded)
+    float maxCaseSeconds = 60.0f;
+    int onlyShader = 0; // 1-based, 0 = all
+    int prepassBlock = 0; // Also time shaders with the depth prepass hook using it, 0 = don't
+};
+
+// One shader at one resolution
+struct BenchCase {
+    BenchResolution resolution;
+    int frames;
+    float p50Ms, p95Ms, p99Ms, meanMs;
+    float megapixelsPerSecond;
+    float prepassP50Ms = 0.0f;  // Same case with the depth prepass, 0 = not measured
+};
+
+struct BenchShader {
+    std::string file;
+    bool compiled;
+    float compileMs;
+    float linkMs;
+    std::vector<BenchCase> cases;
+};
+
+static void printBenchUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "  --backend <name>        egl (default) or osmesa" << std::endl;
+    std::cout << "  --shaders <dir>         Directory with shader1.glsl, shader2.glsl, ... (default ../shaders)" << std::endl;
+    std::cout << "  --shader <n>            Only benchmark shader n" << std::endl;
+    std::cout << "  --resolutions <list>    Comma separated WxH list (default 1280x720,1920x1080,3840x2160)" << std::endl;
+    std::cout << "  --warmup <n>            Unmeasured frames per resolution (default 3)" << std::endl;
+    std::cout << "  --frames <n>            Measured frames per resolution (default 20)" << std::endl;
+    std::cout << "  --max-case-seconds <s>  Stop measuring a resolution after s seconds, 0 = never (default 60)" << std::endl;
+    std::cout << "  --depth-prepass <n>     Time hook shaders again with an n x n block depth prepass, report the speedup" << std::endl;
+    std::cout << "  --output <file>         JSON results (default shader_bench.json)" << std::endl;
+}
+
+static bool parseBenchOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            }
+            printBenchUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--backend") {
+            // Resolutions need a resizable offscreen target
+            if (!parseBackendType(value, options.backend) || options.backend == BACKEND_WINDOW) {
+                std::cerr << "shader_bench needs an offscreen backend (egl or osmesa): " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--shaders") {
+            options.shaderDir = value;
+        } else if (arg == "--shader") {
+            options.onlyShader = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--resolutions") {
+            options.resolutions.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                BenchResolution resolution;
+                if (std::sscanf(item.c_str(), "%dx%d", &resolution.width, &resolution.height) != 2 ||
+                    resolution.width < 1 || resolution.height < 1) {
+                    std::cerr << "Bad resolution: " << item << " (expected WIDTHxHEIGHT)" << std::endl;
+                    return false;
+                }
+                options.resolutions.push_back(resolution);
+            }
+        } else if (arg == "--warmup") {
+            options.warmupFrames = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--frames") {
+            options.measuredFrames = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--max-case-seconds") {
+            options.maxCaseSeconds = std::max(0.0f, static_cast<float>(std::atof(value.c_str())));
+        } else if (arg == "--depth-prepass") {
+            options.prepassBlock = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--output") {
+            options.outputPath = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printBenchUsage(argv[0]);
+            return false;
+        }
+    }
+    return !options.resolutions.empty();
+}
+
+// Escape a string for a JSON literal
+static std::string jsonEscape(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            result += ' ';
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "unknown";
+}
+
+// Host name, OS and CPU model for the result metadata
+static void getHostInfo(std::string& hostName, std::string& osName, std::string& cpuName) {
+#ifdef _WIN32
+    const char* computer = std::getenv("COMPUTERNAME");
+    const char* processor = std::getenv("PROCESSOR_IDENTIFIER");
+    hostName = computer ? computer : "unknown";
+    osName = "Windows";
+    cpuName = processor ? processor : "unknown";
+#else
+    char buffer[256] = {0};
+    hostName = gethostname(buffer, sizeof(buffer) - 1) == 0 ? buffer : "unknown";
+    struct utsname system;
+    osName = uname(&system) == 0 ? std::string(system.sysname) + " " + system.release + " " + system.machine : "unknown";
+    cpuName = "unknown";
+    std::ifstream cpuInfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuInfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos) {
+            cpuName = line.substr(line.find(':') + 2);
+            break;
+        }
+    }
+#endif
+}
+
+// Render one shader at one resolution and collect the per-frame times; with a prepass
+// every frame runs it first
+static BenchCase runCase(ShaderManager& manager, RenderBackend& backend, GLuint quadVAO,
+                         const BenchResolution& resolution, const BenchOptions& options,
+                         DepthPrepass* prepass = nullptr) {
+    backend.resize(resolution.width, resolution.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, backend.getFramebuffer());
+    glViewport(0, 0, resolution.width, resolution.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    std::vector<float> samples;
+    uint64_t caseStart = traceNowNs();
+    int totalFrames = options.warmupFrames + options.measuredFrames;
+    for (int frame = 0; frame < totalFrames; frame++) {
+        // Each frame waits for the GPU, so the wall time is the frame's full cost
+        uint64_t frameStart = traceNowNs();
+        glClear(GL_COLOR_BUFFER_BIT);
+        // iMouse stays at (0, 0, 0, 0): no input
+        manager.setupShaderToyUniforms(resolution.width, resolution.height,
+                                       BENCH_TIMES[frame % BENCH_TIME_COUNT], 1.0f / 60.0f, frame,
+                                       0, resolution.height, false);
+        bool prepassed = prepass && prepass->begin(manager, quadVAO, resolution.width, resolution.height);
+        glBindVertexArray(quadVAO);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        if (prepassed) {
+            prepass->end(manager);
+        }
+        glFinish();
+        uint64_t frameEnd = traceNowNs();
+        if (frame >= options.warmupFrames) {
+            samples.push_back((frameEnd - frameStart) / 1e6f);
+        }
+        if (options.maxCaseSeconds > 0.0f && (frameEnd - caseStart) / 1e9f > options.maxCaseSeconds &&
+            samples.size() >= 3) {
+            break;
+        }
+    }
+
+    BenchCase result;
+    result.resolution = resolution;
+    result.frames = static_cast<int>(samples.size());
+    std::vector<float> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) {
+        size_t index = static_cast<size_t>(p / 100.0f * (sorted.size() - 1) + 0.5f);
+        return sorted.empty() ? 0.0f : sorted[std::min(index, sorted.size() - 1)];
+    };
+    float total = 0.0f;
+    for (float sample : sorted) {
+        total += sample;
+    }
+    result.p50Ms = percentile(50.0f);
+    result.p95Ms = percentile(95.0f);
+    result.p99Ms = percentile(99.0f);
+    result.meanMs = sorted.empty() ? 0.0f : total / sorted.size();
+    float megapixels = resolution.width * static_cast<float>(resolution.height) / 1e6f;
+    result.megapixelsPerSecond = result.p50Ms > 0.0f ? megapixels * 1000.0f / result.p50Ms : 0.0f;
+    return result;
+}
+
+static bool writeBenchJson(const BenchOptions& options, const std::vector<BenchShader>& shaders) {
+    std::FILE* file = std::fopen(options.outputPath.c_str(), "w");
+    if (!file) {
+        std::cerr << "ERROR::BENCH::CANNOT_OPEN_FILE: " << options.outputPath << std::endl;
+        return false;
+    }
+    std::string hostName, osName, cpuName;
+    getHostInfo(hostName, osName, cpuName);
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::fprintf(file, "{\n  \"timestamp\": \"%s\",\n", timestamp);
+    std::fprintf(file, "  \"host\": {\"name\": \"%s\", \"os\": \"%s\", \"cpu\": \"%s\", \"threads\": %u},\n",
+                 jsonEscape(hostName).c_str(), jsonEscape(osName).c_str(), jsonEscape(cpuName).c_str(),
+                 std::thread::hardware_concurrency());
+    std::fprintf(file, "  \"driver\": {\"backend\": \"%s\", \"vendor\": \"%s\", \"renderer\": \"%s\", "
+                 "\"version\": \"%s\", \"glsl\": \"%s\"},\n",
+                 getBackendName(options.backend), jsonEscape(glString(GL_VENDOR)).c_str(),
+                 jsonEscape(glString(GL_RENDERER)).c_str(), jsonEscape(glString(GL_VERSION)).c_str(),
+                 jsonEscape(glString(GL_SHADING_LANGUAGE_VERSION)).c_str());
+    std::fprintf(file, "  \"config\": {\"warmup_frames\": %d, \"measured_frames\": %d, \"max_case_seconds\": %.1f, "
+                 "\"prepass_block\": %d, \"times\": [", options.warmupFrames, options.measuredFrames,
+                 options.maxCaseSeconds, options.prepassBlock);
+    for (int i = 0; i < BENCH_TIME_COUNT; i++) {
+        std::fprintf(file, "%s%.2f", i ? ", " : "", BENCH_TIMES[i]);
+    }
+    std::fprintf(file, "]},\n  \"shaders\": [");
+    for (size_t s = 0; s < shaders.size(); s++) {
+        const BenchShader& shader = shaders[s];
+        std::fprintf(file, "%s\n    {\"file\": \"%s\", \"compiled\": %s, \"compile_ms\": %.3f, \"link_ms\": %.3f, "
+                     "\"results\": [", s ? "," : "", jsonEscape(shader.file).c_str(),
+                     shader.compiled ? "true" : "false", shader.compileMs, shader.linkMs);
+        for (size_t c = 0; c < shader.cases.size(); c++) {
+            const BenchCase& result = shader.cases[c];
+            std::fprintf(file, "%s\n      {\"width\": %d, \"height\": %d, \"frames\": %d, \"p50_ms\": %.3f, "
+                         "\"p95_ms\": %.3f, \"p99_ms\": %.3f, \"mean_ms\": %.3f, \"megapixels_per_s\": %.2f",
+                         c ? "," : "", result.resolution.width, result.resolution.height, result.frames,
+                         result.p50Ms, result.p95Ms, result.p99Ms, result.meanMs, result.megapixelsPerSecond);
+            if (result.prepassP50Ms > 0.0f) {
+                std::fprintf(file, ", \"prepass_p50_ms\": %.3f, \"prepass_speedup\": %.3f",
+                             result.prepassP50Ms, result.p50Ms / result.prepassP50Ms);
+            }
+            std::fprintf(file, "}");
+        }
+        std::fprintf(file, "%s]}", shader.cases.empty() ? "" : "\n    ");
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    std::fclose(file);
+    std::cout << "Results written to: " << options.outputPath << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseBenchOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::unique_ptr<RenderBackend> backend = createRenderBackend(options.backend);
+    if (!backend || !backend->init("shader_bench", options.resolutions[0].width, options.resolutions[0].height)) {
+        std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
+        return 1;
+    }
+    std::cout << "Renderer: " << glString(GL_RENDERER) << " / " << glString(GL_VERSION) << std::endl;
+    GLuint quadVAO = createFullScreenQuad();
+
+    // Every shaderN.glsl in the shader directory, in order
+    std::vector<BenchShader> shaders;
+    for (int index = 1; ; index++) {
+        std::string file = "shader" + std::to_string(index) + ".glsl";
+        std::ifstream probe(options.shaderDir + "/" + file);
+        if (!probe.good()) {
+            break;
+        }
+        probe.close();
+        if (options.onlyShader != 0 && options.onlyShader != index) {
+            continue;
+        }
+
+        BenchShader shader;
+        shader.file = file;
+        ShaderManager manager;
+        std::string code = loadShaderFromFile(options.shaderDir + "/" + file);
+        shader.compiled = !code.empty() &&
+                          manager.loadFromStrings(defaultVertexShader, createShaderToyFragmentShader(code));
+        shader.compileMs = manager.getCompileMs();
+        shader.linkMs = manager.getLinkMs();
+        std::printf("%-14s compile %8.2f ms  link %8.2f ms%s\n", file.c_str(), shader.compileMs, shader.linkMs,
+                    shader.compiled ? "" : "  FAILED");
+        // Shaders that opt into the depth prepass hook are timed with it too
+        DepthPrepass prepass;
+        prepass.setBlockSize(options.prepassBlock);
+        bool usePrepass = options.prepassBlock > 0 && shaderUsesDepthPrepass(code);
+        for (size_t r = 0; shader.compiled && r < options.resolutions.size(); r++) {
+            BenchCase result = runCase(manager, *backend, quadVAO, options.resolutions[r], options);
+            std::printf("  %5dx%-5d %3d frames  p50 %9.2f  p95 %9.2f  p99 %9.2f ms  %8.2f MP/s\n",
+                        result.resolution.width, result.resolution.height, result.frames,
+                        result.p50Ms, result.p95Ms, result.p99Ms, result.megapixelsPerSecond);
+            if (usePrepass) {
+                result.prepassP50Ms = runCase(manager, *backend, quadVAO, options.resolutions[r], options, &prepass).p50Ms;
+                std::printf("  %5dx%-5d depth prepass (%d px blocks)  p50 %9.2f ms  speedup %.2fx\n",
+                            result.resolution.width, result.resolution.height, prepass.getBlockSize(),
+                            result.prepassP50Ms, result.prepassP50Ms > 0.0f ? result.p50Ms / result.prepassP50Ms : 0.0f);
+            }
+            shader.cases.push_back(result);
+        }
+        prepass.release();
+        std::fflush(stdout);
+        shaders.push_back(shader);
+    }
+    if (shaders.empty()) {
+        std::cerr << "No shaders found in " << options.shaderDir << std::endl;
+        return 1;
+    }
+
+    bool written = writeBenchJson(options, shaders);
+    glDeleteVertexArrays(1, &quadVAO);
+    return written ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+// shader_golden: renders shaders at exact iTime/iFrame/iMouse values and compares the
+// frames against stored reference images. Used to check that performance work
+// (lower precision, specialised variants, render scaling) leaves the output alone.
+#include "../include/shader_manager.h"
+#include "../include/includes.h"
+#include "../include/backend.h"
+#include "../include/image_io.h"
+#include "../include/render_target.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#define makeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+// One frame to check: exact uniform values, mouse as a fraction of the image size
+struct GoldenCase {
+    const char* tag;
+    float time;
+    int frame;
+    float mouseX, mouseY;
+    bool mouseDown;
+};
+
+const GoldenCase GOLDEN_CASES[] = {
+    {"t1", 1.0f, 60, 0.0f, 0.0f, false},
+    {"t7_mouse", 7.5f, 450, 0.3f, 0.6f, true}
+};
+const int GOLDEN_CASE_COUNT = sizeof(GOLDEN_CASES) / sizeof(GOLDEN_CASES[0]);
+
+struct GoldenOptions {
+    BackendType backend = BACKEND_EGL;
+    std::string shaderDir = "../shaders";
+    std::string referenceDir = "../golden";
+    int width = 256;
+    int height = 144;
+    int onlyShader = 0;          // 1-based, 0 = all
+    bool update = false;         // Write references instead of comparing
+    int tolerance = 8;           // Max per-channel difference of a matching pixel (0-255)
+    float maxBadFraction = 0.001f; // Fraction of pixels allowed outside the tolerance
+    float renderScale = 1.0f;    // Render smaller and upscale, like the watchdog does
+    ShaderDefines defines;       // Overrides applied to every shader
+};
+
+static void printGoldenUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "  --update                Render and store the reference images" << std::endl;
+    std::cout << "  --backend <name>        egl (default) or osmesa" << std::endl;
+    std::cout << "  --shaders <dir>         Directory with shader1.glsl, ... (default ../shaders)" << std::endl;
+    std::cout << "  --refs <dir>            Reference image directory (default ../golden)" << std::endl;
+    std::cout << "  --shader <n>            Only check shader n" << std::endl;
+    std::cout << "  --size <WxH>            Image size (default 256x144)" << std::endl;
+    std::cout << "  --tolerance <n>         Per-channel difference a pixel may have, 0-255 (default 8)" << std::endl;
+    std::cout << "  --max-bad <fraction>    Fraction of pixels allowed outside the tolerance (default 0.001)" << std::endl;
+    std::cout << "  --scale <f>             Render at f x size and upscale before comparing" << std::endl;
+    std::cout << "  --define NAME=VALUE     Override a #define / const in every shader (repeatable)" << std::endl;
+}
+
+static bool parseGoldenOptions(int argc, char* argv[], GoldenOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--update") {
+            options.update = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            }
+            printGoldenUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--backend") {
+            if (!parseBackendType(value, options.backend) || options.backend == BACKEND_WINDOW) {
+                std::cerr << "shader_golden needs an offscreen backend (egl or osmesa): " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--shaders") {
+            options.shaderDir = value;
+        } else if (arg == "--refs") {
+            options.referenceDir = value;
+        } else if (arg == "--shader") {
+            options.onlyShader = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--size") {
+            if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width < 1 || options.height < 1) {
+                std::cerr << "--size expects WIDTHxHEIGHT" << std::endl;
+                return false;
+            }
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::max(0, std::min(255, std::atoi(value.c_str())));
+        } else if (arg == "--max-bad") {
+            options.maxBadFraction = std::max(0.0f, static_cast<float>(std::atof(value.c_str())));
+        } else if (arg == "--scale") {
+            options.renderScale = std::max(0.05f, std::min(1.0f, static_cast<float>(std::atof(value.c_str()))));
+        } else if (arg == "--define") {
+            size_t equals = value.find('=');
+            if (equals == std::string::npos || equals == 0) {
+                std::cerr << "--define expects NAME=VALUE" << std::endl;
+                return false;
+            }
+            options.defines[value.substr(0, equals)] = value.substr(equals + 1);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printGoldenUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Render one case into the backend's screen and read it back
+static bool renderCase(ShaderManager& manager, RenderBackend& backend, RenderTarget& scaled, GLuint quadVAO,
+                       const GoldenCase& golden, const GoldenOptions& options, std::vector<unsigned char>& pixels) {
+    int renderWidth = std::max(1, static_cast<int>(options.width * options.renderScale));
+    int renderHeight = std::max(1, static_cast<int>(options.height * options.renderScale));
+    bool useScaled = renderWidth != options.width || renderHeight != options.height;
+    if (useScaled && scaled.resize(renderWidth, renderHeight)) {
+        scaled.bind();
+    } else {
+        useScaled = false;
+        renderWidth = options.width;
+        renderHeight = options.height;
+        glBindFramebuffer(GL_FRAMEBUFFER, backend.getFramebuffer());
+        glViewport(0, 0, renderWidth, renderHeight);
+    }
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    // Mouse is given top-down like SDL, setupShaderToyUniforms flips it
+    int mouseX = static_cast<int>(golden.mouseX * renderWidth);
+    int mouseY = renderHeight - static_cast<int>(golden.mouseY * renderHeight);
+    manager.setupShaderToyUniforms(renderWidth, renderHeight, golden.time, 1.0f / 60.0f, golden.frame,
+                                   mouseX, mouseY, golden.mouseDown);
+    glBindVertexArray(quadVAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    if (useScaled) {
+        scaled.blitToScreen(options.width, options.height, backend.getFramebuffer());
+    }
+    return readFramebufferRGBA(backend.getFramebuffer(), options.width, options.height, pixels);
+}
+
+// Compare against the reference; fills a diff image (dimmed reference, failing pixels red)
+static int comparePixels(const std::vector<unsigned char>& actual, const std::vector<unsigned char>& reference,
+                         int tolerance, int& maxDifference, std::vector<unsigned char>& diff) {
+    int badPixels = 0;
+    maxDifference = 0;
+    diff.resize(actual.size());
+    for (size_t i = 0; i + 3 < actual.size(); i += 4) {
+        int difference = 0;
+        for (int c = 0; c < 3; c++) {
+            difference = std::max(difference, std::abs(actual[i + c] - reference[i + c]));
+        }
+        maxDifference = std::max(maxDifference, difference);
+        unsigned char gray = static_cast<unsigned char>((reference[i] + reference[i + 1] + reference[i + 2]) / 12);
+        if (difference > tolerance) {
+            badPixels++;
+            diff[i + 0] = static_cast<unsigned char>(std::min(255, 128 + difference));
+            diff[i + 1] = 0;
+            diff[i + 2] = 0;
+        } else {
+            diff[i + 0] = diff[i + 1] = diff[i + 2] = gray;
+        }
+        diff[i + 3] = 255;
+    }
+    return badPixels;
+}
+
+int main(int argc, char* argv[]) {
+    GoldenOptions options;
+    if (!parseGoldenOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::unique_ptr<RenderBackend> backend = createRenderBackend(options.backend);
+    if (!backend || !backend->init("shader_golden", options.width, options.height)) {
+        std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
+        return 1;
+    }
+    GLuint quadVAO = createFullScreenQuad();
+    RenderTarget scaled;
+
+    uint64_t startNs = traceNowNs();
+    if (options.update) {
+        makeDirectory(options.referenceDir.c_str());
+    }
+    int checked = 0, passed = 0, failed = 0, missing = 0;
+    for (int index = 1; ; index++) {
+        std::string name = "shader" + std::to_string(index);
+        std::ifstream probe(options.shaderDir + "/" + name + ".glsl");
+        if (!probe.good()) {
+            break;
+        }
+        probe.close();
+        if (options.onlyShader != 0 && options.onlyShader != index) {
+            continue;
+        }
+        std::string code = loadShaderFromFile(options.shaderDir + "/" + name + ".glsl");
+        ShaderManager manager;
+        if (!manager.loadFromStrings(defaultVertexShader, createShaderToyFragmentShader(code, options.defines))) {
+            std::cout << "FAIL    " << name << " (compile)" << std::endl;
+            failed++;
+            continue;
+        }
+
+        for (int c = 0; c < GOLDEN_CASE_COUNT; c++) {
+            const GoldenCase& golden = GOLDEN_CASES[c];
+            std::string base = options.referenceDir + "/" + name + "_" + golden.tag;
+            std::vector<unsigned char> pixels;
+            if (!renderCase(manager, *backend, scaled, quadVAO, golden, options, pixels)) {
+                failed++;
+                continue;
+            }
+            checked++;
+
+            if (options.update) {
+                if (!writePPM(base + ".ppm", options.width, options.height, pixels)) {
+                    failed++;
+                }
+                continue;
+            }
+
+            int referenceWidth = 0, referenceHeight = 0;
+            std::vector<unsigned char> reference;
+            std::ifstream referenceProbe(base + ".ppm");
+            if (!referenceProbe.good()) {
+                std::cout << "MISSING " << base << ".ppm (run with --update)" << std::endl;
+                missing++;
+                continue;
+            }
+            referenceProbe.close();
+            if (!readPPM(base + ".ppm", referenceWidth, referenceHeight, reference) ||
+                referenceWidth != options.width || referenceHeight != options.height) {
+                std::cout << "FAIL    " << name << "_" << golden.tag << " (reference is "
+                          << referenceWidth << "x" << referenceHeight << ")" << std::endl;
+                failed++;
+                continue;
+            }
+
+            int maxDifference = 0;
+            std::vector<unsigned char> diff;
+            int badPixels = comparePixels(pixels, reference, options.tolerance, maxDifference, diff);
+            float badFraction = badPixels / static_cast<float>(options.width * options.height);
+            bool pass = badFraction <= options.maxBadFraction;
+            std::printf("%s %-20s max diff %3d  bad pixels %6d (%.4f%%)\n", pass ? "ok     " : "FAIL   ",
+                        (name + "_" + golden.tag).c_str(), maxDifference, badPixels, badFraction * 100.0f);
+            if (pass) {
+                passed++;
+            } else {
+                failed++;
+                writePPM(base + ".actual.ppm", options.width, options.height, pixels);
+                writePPM(base + ".diff.ppm", options.width, options.height, diff);
+            }
+        }
+    }
+    glDeleteVertexArrays(1, &quadVAO);
+
+    float seconds = (traceNowNs() - startNs) / 1e9f;
+    if (options.update) {
+        std::cout << "Stored " << checked << " reference images in " << options.referenceDir
+                  << " (" << seconds << " s)" << std::endl;
+    } else {
+        std::cout << passed << "/" << checked << " images match, " << failed << " failed, "
+                  << missing << " missing (" << seconds << " s)" << std::endl;
+    }
+    return failed == 0 && missing == 0 ? 0 : 1;
+}
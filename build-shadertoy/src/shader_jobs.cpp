@@ -0,0 +1,420 @@
+// shader_jobs: renders the frames listed in a job file offline. Jobs are grouped by
+// resolution and shader so every program is compiled once and every render target
+// size is allocated once; finished frames are checkpointed, so an interrupted run
+// picks up where it stopped.
+//
+// Job file, one job per line ('#' starts a comment):
+//   <shader> <times> <WxH> <output> [NAME=VALUE ...]
+//   shader   number n (shaders/shader<n>.glsl) or a path to a .glsl file
+//   times    start-end@fps (end excluded), or a comma separated list of seconds
+//   output   PPM path, with a printf %d (or %0Nd) for the frame number if there is more than
+//            one frame; any other '%' is written "%%"
+//   NAME=VALUE  quality knobs, applied like shader_golden --define
+// Example:
+//   5  0-4@30         1920x1080  out/s5_%04d.ppm
+//   3  1,2.5,7        640x360    out/s3_%d.ppm     MAX_STEPS=64
+#include "../include/shader_manager.h"
+#include "../include/includes.h"
+#include "../include/async_readback.h"
+#include "../include/backend.h"
+#include "../include/image_io.h"
+#include "../include/render_target.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+
+struct RenderJob {
+    int line;                   // Line in the job file, for messages
+    std::string shaderPath;
+    ShaderDefines defines;
+    std::string programKey;     // Shader path plus defines; jobs with the same key share a program
+    int width;
+    int height;
+    std::vector<float> times;
+    std::string outputPattern;
+    bool failed = false;
+};
+
+// One frame of one job
+struct RenderUnit {
+    int job;
+    int index;
+    float time;
+    std::string outputPath;
+    int attempts = 0;
+};
+
+struct JobOptions {
+    BackendType backend = BACKEND_EGL;
+    std::string jobPath;
+    std::string shaderDir = "../shaders";
+    std::string checkpointPath;     // Default: <job file>.done
+    int retries = 2;
+    bool restart = false;
+};
+
+static void printJobsUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] <job file>" << std::endl;
+    std::cout << "  --backend <name>        egl (default) or osmesa" << std::endl;
+    std::cout << "  --shaders <dir>         Directory numbered shaders are loaded from (default ../shaders)" << std::endl;
+    std::cout << "  --checkpoint <file>     Finished frames are appended here (default <job file>.done)" << std::endl;
+    std::cout << "  --retries <n>           Extra attempts for a frame that failed (default 2)" << std::endl;
+    std::cout << "  --restart               Ignore the checkpoint and render everything again" << std::endl;
+}
+
+static bool parseJobsOptions(int argc, char* argv[], JobOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--restart") {
+            options.restart = true;
+            continue;
+        }
+        if (arg.empty() || arg[0] != '-') {
+            options.jobPath = arg;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            }
+            printJobsUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--backend") {
+            if (!parseBackendType(value, options.backend) || options.backend == BACKEND_WINDOW) {
+                std::cerr << "shader_jobs needs an offscreen backend (egl or osmesa): " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--shaders") {
+            options.shaderDir = value;
+        } else if (arg == "--checkpoint") {
+            options.checkpointPath = value;
+        } else if (arg == "--retries") {
+            options.retries = std::max(0, std::atoi(value.c_str()));
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printJobsUsage(argv[0]);
+            return false;
+        }
+    }
+    if (options.jobPath.empty()) {
+        printJobsUsage(argv[0]);
+        return false;
+    }
+    if (options.checkpointPath.empty()) {
+        options.checkpointPath = options.jobPath + ".done";
+    }
+    return true;
+}
+
+// Parse "start-end@fps" or "t0,t1,..."
+static bool parseTimes(const std::string& text, std::vector<float>& times) {
+    float start = 0.0f, end = 0.0f, fps = 0.0f;
+    if (std::sscanf(text.c_str(), "%f-%f@%f", &start, &end, &fps) == 3) {
+        if (fps <= 0.0f || end <= start) {
+            return false;
+        }
+        int count = static_cast<int>((end - start) * fps + 0.5f);
+        for (int i = 0; i < count; i++) {
+            times.push_back(start + i / fps);
+        }
+        return true;
+    }
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        char* endPointer = nullptr;
+        float time = std::strtof(item.c_str(), &endPointer);
+        if (item.empty() || *endPointer != '\0') {
+            return false;
+        }
+        times.push_back(time);
+    }
+    return !times.empty();
+}
+
+// Frame number conversions (%d, %4d or %04d) in an output pattern; -1 if it holds any
+// other conversion, which would make snprintf read arguments it is never given. "%%"
+// stands for a literal '%'.
+static int countFrameConversions(const std::string& pattern) {
+    int count = 0;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] != '%') {
+            continue;
+        }
+        i++;
+        if (i < pattern.size() && pattern[i] == '%') {
+            continue;
+        }
+        while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+            i++;
+        }
+        if (i >= pattern.size() || pattern[i] != 'd') {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+static bool loadJobFile(const JobOptions& options, std::vector<RenderJob>& jobs) {
+    std::ifstream file(options.jobPath);
+    if (!file.good()) {
+        std::cerr << "ERROR::JOBS::CANNOT_OPEN_FILE: " << options.jobPath << std::endl;
+        return false;
+    }
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::stringstream tokens(line);
+        std::string shader, times, size, output;
+        if (!(tokens >> shader)) {
+            continue;
+        }
+        RenderJob job;
+        job.line = lineNumber;
+        bool ok = static_cast<bool>(tokens >> times >> size >> output);
+        ok = ok && parseTimes(times, job.times);
+        ok = ok && std::sscanf(size.c_str(), "%dx%d", &job.width, &job.height) == 2 && job.width > 0 && job.height > 0;
+        // The output name takes exactly one frame number, which a single frame may leave out
+        int conversions = countFrameConversions(output);
+        ok = ok && (conversions == 1 || (conversions == 0 && job.times.size() == 1));
+        std::string define;
+        while (ok && tokens >> define) {
+            size_t equals = define.find('=');
+            ok = equals != std::string::npos && equals != 0;
+            if (ok) {
+                job.defines[define.substr(0, equals)] = define.substr(equals + 1);
+            }
+        }
+        if (!ok) {
+            std::cerr << options.jobPath << ":" << lineNumber << ": expected <shader> <times> <WxH> <output> "
+                      << "[NAME=VALUE ...], with one %d (or %0Nd) in the output for more than one frame "
+                      << "and no other % but %%" << std::endl;
+            return false;
+        }
+        bool numbered = shader.find_first_not_of("0123456789") == std::string::npos;
+        job.shaderPath = numbered ? options.shaderDir + "/shader" + shader + ".glsl" : shader;
+        job.programKey = job.shaderPath;
+        for (const auto& knob : job.defines) {
+            job.programKey += " " + knob.first + "=" + knob.second;
+        }
+        job.outputPattern = output;
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+static std::string formatOutputPath(const std::string& pattern, int index) {
+    if (pattern.find('%') == std::string::npos) {
+        return pattern;
+    }
+    char path[1024];
+    std::snprintf(path, sizeof(path), pattern.c_str(), index);
+    return path;
+}
+
+int main(int argc, char* argv[]) {
+    JobOptions options;
+    if (!parseJobsOptions(argc, argv, options)) {
+        return 1;
+    }
+    std::vector<RenderJob> jobs;
+    if (!loadJobFile(options, jobs)) {
+        return 1;
+    }
+
+    // Frames finished by an earlier run
+    std::set<std::string> finished;
+    if (!options.restart) {
+        std::ifstream checkpoint(options.checkpointPath);
+        std::string path;
+        while (std::getline(checkpoint, path)) {
+            finished.insert(path);
+        }
+    }
+    std::FILE* checkpointFile = std::fopen(options.checkpointPath.c_str(), options.restart ? "w" : "a");
+    if (!checkpointFile) {
+        std::cerr << "ERROR::JOBS::CANNOT_OPEN_FILE: " << options.checkpointPath << std::endl;
+        return 1;
+    }
+
+    std::vector<RenderUnit> pending;
+    int skipped = 0;
+    for (size_t j = 0; j < jobs.size(); j++) {
+        for (size_t i = 0; i < jobs[j].times.size(); i++) {
+            RenderUnit unit;
+            unit.job = static_cast<int>(j);
+            unit.index = static_cast<int>(i);
+            unit.time = jobs[j].times[i];
+            unit.outputPath = formatOutputPath(jobs[j].outputPattern, unit.index);
+            if (finished.count(unit.outputPath)) {
+                skipped++;
+            } else {
+                pending.push_back(unit);
+            }
+        }
+    }
+    // Resolution changes reallocate the target and program changes rebind state, so
+    // sort by size first and shader second; the file order is kept inside a group
+    std::stable_sort(pending.begin(), pending.end(), [&jobs](const RenderUnit& a, const RenderUnit& b) {
+        const RenderJob& jobA = jobs[a.job];
+        const RenderJob& jobB = jobs[b.job];
+        if (jobA.width != jobB.width || jobA.height != jobB.height) {
+            return jobA.width * jobA.height != jobB.width * jobB.height ?
+                   jobA.width * jobA.height < jobB.width * jobB.height : jobA.width < jobB.width;
+        }
+        return jobA.programKey < jobB.programKey;
+    });
+    int total = static_cast<int>(pending.size()) + skipped;
+    std::cout << jobs.size() << " jobs, " << total << " frames";
+    if (skipped > 0) {
+        std::cout << " (" << skipped << " already done, resuming from " << options.checkpointPath << ")";
+    }
+    std::cout << std::endl;
+
+    // The context starts small; the target follows the groups
+    std::unique_ptr<RenderBackend> backend = createRenderBackend(options.backend);
+    if (!backend || !backend->init("shader_jobs", 64, 64)) {
+        std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
+        return 1;
+    }
+    GLuint quadVAO = createFullScreenQuad();
+    RenderTarget target;
+    std::map<std::string, std::unique_ptr<ShaderManager>> programs;
+
+    // The readback consumer writes the images and records them in the checkpoint
+    std::mutex resultMutex;
+    std::vector<int> failedUnits;
+    int done = skipped;
+    AsyncReadback readback;
+    AsyncReadback::Consumer writeFrame = [&](ReadbackFrame& frame) {
+        TRACE_SCOPE("job write");
+        bool written = writePPM(frame.tag, frame.width, frame.height, frame.pixels);
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (written) {
+            std::fprintf(checkpointFile, "%s\n", frame.tag.c_str());
+            std::fflush(checkpointFile);
+            done++;
+        } else {
+            failedUnits.push_back(static_cast<int>(frame.frameIndex));
+        }
+    };
+
+    int compiles = 0, targetResizes = 0, programSwitches = 0, retried = 0, failed = 0;
+    uint64_t startNs = traceNowNs();
+    uint64_t lastReportNs = startNs;
+    for (int attempt = 0; !pending.empty(); attempt++) {
+        const ShaderManager* boundProgram = nullptr;
+        readback.start(writeFrame);
+        for (size_t u = 0; u < pending.size(); u++) {
+            RenderUnit& unit = pending[u];
+            RenderJob& job = jobs[unit.job];
+            unit.attempts++;
+            if (job.failed) {
+                continue;
+            }
+
+            std::unique_ptr<ShaderManager>& program = programs[job.programKey];
+            if (!program) {
+                program.reset(new ShaderManager());
+                std::string code = loadShaderFromFile(job.shaderPath);
+                compiles++;
+                if (code.empty() ||
+                    !program->loadFromStrings(defaultVertexShader, createShaderToyFragmentShader(code, job.defines))) {
+                    // Compiling again gives the same answer; the whole job fails
+                    std::cerr << options.jobPath << ":" << job.line << ": cannot compile " << job.shaderPath << std::endl;
+                    job.failed = true;
+                    continue;
+                }
+            }
+            if (!program->getProgramID()) {
+                job.failed = true;
+                continue;
+            }
+            if (target.getWidth() != job.width || target.getHeight() != job.height) {
+                targetResizes++;
+                if (!target.resize(job.width, job.height)) {
+                    std::cerr << "Cannot allocate a " << job.width << "x" << job.height << " target" << std::endl;
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    failedUnits.push_back(static_cast<int>(u));
+                    continue;
+                }
+            }
+            programSwitches += boundProgram != program.get() ? 1 : 0;
+            boundProgram = program.get();
+
+            TRACE_SCOPE("job frame");
+            target.bind();
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            program->setupShaderToyUniforms(job.width, job.height, unit.time, 1.0f / 60.0f,
+                                            static_cast<int>(unit.time * 60.0f), 0, job.height, false);
+            glBindVertexArray(quadVAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                std::cerr << "GL error 0x" << std::hex << error << std::dec << " rendering " << unit.outputPath << std::endl;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                failedUnits.push_back(static_cast<int>(u));
+                continue;
+            }
+            if (!readback.request(target.getFramebuffer(), job.width, job.height, u, unit.outputPath)) {
+                // No write will report back for this frame
+                std::cerr << "Readback failed for " << unit.outputPath << std::endl;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                failedUnits.push_back(static_cast<int>(u));
+                continue;
+            }
+            readback.poll();
+
+            uint64_t now = traceNowNs();
+            if (now - lastReportNs > 1000000000ull) {
+                lastReportNs = now;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                double rate = (done - skipped) * 1e9 / (now - startNs);
+                std::printf("  [%d/%d] %.1f frames/s, ETA %.0f s, %s\n", done, total, rate,
+                            rate > 0.0 ? (total - done) / rate : 0.0, unit.outputPath.c_str());
+                std::fflush(stdout);
+            }
+        }
+        // Every write of this round has to be in before the failures are collected
+        readback.finish();
+
+        // Whatever failed goes round again until it runs out of attempts
+        std::vector<RenderUnit> again;
+        std::lock_guard<std::mutex> lock(resultMutex);
+        std::sort(failedUnits.begin(), failedUnits.end());
+        failedUnits.erase(std::unique(failedUnits.begin(), failedUnits.end()), failedUnits.end());
+        for (int index : failedUnits) {
+            if (pending[index].attempts <= options.retries) {
+                again.push_back(pending[index]);
+                retried++;
+            } else {
+                std::cerr << "FAILED  " << pending[index].outputPath << " after "
+                          << pending[index].attempts << " attempts" << std::endl;
+                failed++;
+            }
+        }
+        failedUnits.clear();
+        pending.swap(again);
+    }
+    std::fclose(checkpointFile);
+    programs.clear();
+    glDeleteVertexArrays(1, &quadVAO);
+
+    int jobFailures = 0;
+    for (const RenderJob& job : jobs) {
+        jobFailures += job.failed ? 1 : 0;
+    }
+    double seconds = (traceNowNs() - startNs) / 1e9;
+    std::cout << done << "/" << total << " frames done in " << seconds << " s: " << compiles << " programs compiled, "
+              << targetResizes << " target allocations, " << programSwitches << " program switches, "
+              << retried << " retries, " << failed << " frames and " << jobFailures << " jobs failed" << std::endl;
+    return done == total ? 0 : 1;
+}
@@ -1,20 +1,43 @@
 #include "../include/shader_manager.h"
+#include "../include/trace.h"
 
-ShaderManager::ShaderManager() : programID(0) {
+ShaderManager::ShaderManager() : programID(0), baseProgramID(0), compileMs(0.0f), linkMs(0.0f) {
 }
 
 ShaderManager::~ShaderManager() {
-    if (programID != 0) {
-        glDeleteProgram(programID);
+    releasePrograms();
+}
+
+void ShaderManager::releasePrograms() {
+    if (baseProgramID != 0) {
+        glDeleteProgram(baseProgramID);
+    }
+    for (auto& entry : variants) {
+        Variant& variant = entry.second;
+        if (variant.state == VARIANT_COMPILING) {
+            glDeleteShader(variant.vertexShader);
+            glDeleteShader(variant.fragmentShader);
+        }
+        if (variant.program != 0) {
+            glDeleteProgram(variant.program);
+        }
     }
+    variants.clear();
+    selectedVariant.clear();
+    shaderToyCode.clear();
+    programID = 0;
+    baseProgramID = 0;
 }
 
 bool ShaderManager::loadFromStrings(const std::string& vertexSource, const std::string& fragmentSource) {
-    // Create shader program
-    if (programID != 0) {
-        glDeleteProgram(programID);
-    }
+    TRACE_SCOPE("shader compile");
+
+    // Create shader program; variants of the previous source go with it
+    releasePrograms();
     
+    // Compile status queries wait for the driver, so the timings are complete
+    uint64_t compileStart = traceNowNs();
+
     // Vertex shader
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     const char* vShaderCode = vertexSource.c_str();
@@ -36,12 +59,20 @@ bool ShaderManager::loadFromStrings(const std::string& vertexSource, const std::
         return false;
     }
     
+    uint64_t linkStart = traceNowNs();
+    compileMs = (linkStart - compileStart) / 1e6f;
+
     // Shader program
     programID = glCreateProgram();
     glAttachShader(programID, vertexShader);
     glAttachShader(programID, fragmentShader);
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(programID);
-    if (!checkLinkErrors(programID)) {
+    bool linked = checkLinkErrors(programID);
+    linkMs = (traceNowNs() - linkStart) / 1e6f;
+    if (!linked) {
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
         glDeleteProgram(programID);
@@ -53,6 +84,159 @@ bool ShaderManager::loadFromStrings(const std::string& vertexSource, const std::
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
     
+    baseProgramID = programID;
+    return true;
+}
+
+bool ShaderManager::loadShaderToy(const std::string& code) {
+    if (!loadFromStrings(defaultVertexShader, createShaderToyFragmentShader(code))) {
+        return false;
+    }
+    shaderToyCode = code;
+    return true;
+}
+
+VariantState ShaderManager::requestVariant(const ShaderDefines& defines) {
+    std::string key = getShaderDefinesKey(defines);
+    if (key.empty()) {
+        return baseProgramID != 0 ? VARIANT_READY : VARIANT_FAILED;
+    }
+    std::map<std::string, Variant>::iterator entry = variants.find(key);
+    if (entry == variants.end()) {
+        if (shaderToyCode.empty()) {
+            // Loaded from a binary or plain strings: there is no code to apply the set to
+            return VARIANT_FAILED;
+        }
+        Variant variant = {defines, VARIANT_QUEUED, 0, 0, 0};
+        entry = variants.insert(std::make_pair(key, variant)).first;
+    }
+    return entry->second.state;
+}
+
+bool ShaderManager::selectVariant(const ShaderDefines& defines) {
+    std::string key = getShaderDefinesKey(defines);
+    if (key == selectedVariant && programID != 0) {
+        return true;
+    }
+    if (requestVariant(defines) != VARIANT_READY) {
+        return false;
+    }
+    programID = key.empty() ? baseProgramID : variants[key].program;
+    selectedVariant = key;
+    return true;
+}
+
+bool ShaderManager::pollVariants(bool startNext) {
+    bool compiling = false;
+    for (auto& entry : variants) {
+        if (entry.second.state == VARIANT_COMPILING) {
+            collectVariant(entry.second, false);
+            compiling = compiling || entry.second.state == VARIANT_COMPILING;
+        }
+    }
+    // One compile in flight at a time, so a burst of requests is spread over frames
+    if (!startNext || compiling) {
+        return false;
+    }
+    for (auto& entry : variants) {
+        if (entry.second.state == VARIANT_QUEUED) {
+            startVariant(entry.second);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShaderManager::compileVariant(const ShaderDefines& defines) {
+    VariantState state = requestVariant(defines);
+    if (state == VARIANT_READY || state == VARIANT_FAILED) {
+        return state == VARIANT_READY;
+    }
+    Variant& variant = variants[getShaderDefinesKey(defines)];
+    if (variant.state == VARIANT_QUEUED) {
+        startVariant(variant);
+    }
+    collectVariant(variant, true);
+    return variant.state == VARIANT_READY;
+}
+
+void ShaderManager::startVariant(Variant& variant) {
+    TRACE_SCOPE("variant compile");
+    // No status queries here: they would wait for the driver to finish
+    std::string fragmentSource = createShaderToyFragmentShader(shaderToyCode, variant.defines);
+    const char* vShaderCode = defaultVertexShader;
+    const char* fShaderCode = fragmentSource.c_str();
+    variant.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(variant.vertexShader, 1, &vShaderCode, NULL);
+    glCompileShader(variant.vertexShader);
+    variant.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(variant.fragmentShader, 1, &fShaderCode, NULL);
+    glCompileShader(variant.fragmentShader);
+    variant.program = glCreateProgram();
+    glAttachShader(variant.program, variant.vertexShader);
+    glAttachShader(variant.program, variant.fragmentShader);
+    glLinkProgram(variant.program);
+    variant.state = VARIANT_COMPILING;
+}
+
+void ShaderManager::collectVariant(Variant& variant, bool wait) {
+    if (!wait && GLEW_KHR_parallel_shader_compile) {
+        GLint complete = GL_FALSE;
+        glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (!complete) {
+            return;
+        }
+    }
+    TRACE_SCOPE("variant link");
+    bool ok = checkCompileErrors(variant.vertexShader, "VERTEX") &&
+              checkCompileErrors(variant.fragmentShader, "FRAGMENT") && checkLinkErrors(variant.program);
+    glDeleteShader(variant.vertexShader);
+    glDeleteShader(variant.fragmentShader);
+    variant.vertexShader = 0;
+    variant.fragmentShader = 0;
+    if (!ok) {
+        glDeleteProgram(variant.program);
+        variant.program = 0;
+    }
+    variant.state = ok ? VARIANT_READY : VARIANT_FAILED;
+}
+
+bool ShaderManager::getProgramBinary(std::vector<unsigned char>& binary, GLenum& format) const {
+    if (programID == 0 || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    binary.resize(length);
+    GLsizei written = 0;
+    glGetProgramBinary(programID, length, &written, &format, binary.data());
+    binary.resize(written);
+    return written > 0;
+}
+
+bool ShaderManager::loadFromBinary(const std::vector<unsigned char>& binary, GLenum format) {
+    if (binary.empty() || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+        return false;
+    }
+    TRACE_SCOPE("shader binary load");
+    releasePrograms();
+    uint64_t loadStart = traceNowNs();
+    programID = glCreateProgram();
+    glProgramBinary(programID, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = GL_FALSE;
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    compileMs = 0.0f;
+    linkMs = (traceNowNs() - loadStart) / 1e6f;
+    if (!success) {
+        // Driver or version changed; the caller compiles from source instead
+        glDeleteProgram(programID);
+        programID = 0;
+        return false;
+    }
+    baseProgramID = programID;
     return true;
 }
 
@@ -62,6 +246,12 @@ void ShaderManager::use() {
     }
 }
 
+bool ShaderManager::readsTime() const {
+    return programID != 0 && (glGetUniformLocation(programID, "iTime") != -1 ||
+                              glGetUniformLocation(programID, "iTimeDelta") != -1 ||
+                              glGetUniformLocation(programID, "iFrame") != -1);
+}
+
 void ShaderManager::setFloat(const std::string& name, float value) {
     glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
 }
@@ -90,7 +280,12 @@ void ShaderManager::setupShaderToyUniforms(int windowWidth, int windowHeight, fl
     setFloat("iTime", time);
     setFloat("iTimeDelta", deltaTime);
     setInt("iFrame", frame);
+    setInt("iSdfVolume", SHADERTOY_SDF_VOLUME_UNIT);
     
+    setupShaderToyMouse(windowHeight, mouseX, mouseY, mouseDown);
+}
+
+void ShaderManager::setupShaderToyMouse(int windowHeight, int mouseX, int mouseY, bool mouseDown) {
     // Mouse position and click state
     float mx = static_cast<float>(mouseX);
     float my = static_cast<float>(windowHeight - mouseY); // Invert Y for ShaderToy compatibility
@@ -102,6 +297,33 @@ void ShaderManager::setupShaderToyUniforms(int windowWidth, int windowHeight, fl
     }
 }
 
+void ShaderManager::setupShaderToyTile(int x, int y, int width, int height) {
+    use();
+    setVec4("iTile", (float)x, (float)y, (float)width, (float)height);
+}
+
+void ShaderManager::setupShaderToyJitter(float x, float y) {
+    use();
+    setVec2("iJitter", x, y);
+}
+
+void ShaderManager::setupShaderToyInterleave(float strideX, float strideY, float offsetX, float offsetY) {
+    use();
+    setVec4("iInterleave", strideX, strideY, offsetX, offsetY);
+}
+
+void ShaderManager::setupShaderToyPrepass(int mode, int blockSize, int textureUnit) {
+    use();
+    setVec2("iPrepass", static_cast<float>(mode), static_cast<float>(blockSize));
+    setInt("iPrepassDepth", textureUnit);
+}
+
+void ShaderManager::setupShaderToySdfVolume(bool enabled, const float boundsMin[3], const float boundsMax[3], float error) {
+    use();
+    setVec4("iSdfBoundsMin", boundsMin[0], boundsMin[1], boundsMin[2], enabled ? 1.0f : 0.0f);
+    setVec4("iSdfBoundsMax", boundsMax[0], boundsMax[1], boundsMax[2], error);
+}
+
 bool ShaderManager::checkCompileErrors(GLuint shader, const std::string& type) {
     GLint success;
     GLchar infoLog[1024];
@@ -0,0 +1,166 @@
+// shader_sdfbake: samples the static distance function of every shader that defines
+// SHADERTOY_STATIC_SDF(p) into a 3D grid, once, and keeps it in ../shaderN.sdf.cache
+// keyed by the source hash. The renderer (--baked-sdf) marches through the volume far
+// from surfaces and only evaluates the exact function near them.
+#include "../include/shader_manager.h"
+#include "../include/includes.h"
+#include "../include/backend.h"
+#include "../include/file_io.h"
+#include "../include/sdf_bake.h"
+#include "../include/trace.h"
+#include <cstdio>
+#include <cstdlib>
+
+struct SdfBakeOptions {
+    BackendType backend = BACKEND_EGL;
+    std::string shaderDir = "../shaders";
+    std::string cacheDir = "..";
+    int shader = 0;                 // Only shaderN, 0 = all
+    bool overrideBounds = false;    // --bounds replaces the shader's sdf-bounds
+    SdfBakeSettings settings;
+    bool overrideResolution = false;
+    bool force = false;             // Ignore the cache
+};
+
+static void printSdfBakeUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "  --backend <name>        egl (default) or osmesa" << std::endl;
+    std::cout << "  --shaders <dir>         Directory with shader1.glsl, ... (default ../shaders)" << std::endl;
+    std::cout << "  --cache-dir <dir>       Where the shaderN.sdf.cache files go (default ..)" << std::endl;
+    std::cout << "  --shader <n>            Bake only shaderN" << std::endl;
+    std::cout << "  --bounds <x0,y0,z0,x1,y1,z1>  Region to sample (default: the shader's sdf-bounds)" << std::endl;
+    std::cout << "  --resolution <n>        Samples along the longest side, 2-512 (default "
+              << DEFAULT_SDF_BAKE_RESOLUTION << ")" << std::endl;
+    std::cout << "  --force                 Bake again even if the cache is current" << std::endl;
+}
+
+static bool parseSdfBakeOptions(int argc, char* argv[], SdfBakeOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--force") {
+            options.force = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            }
+            printSdfBakeUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--backend") {
+            if (!parseBackendType(value, options.backend) || options.backend == BACKEND_WINDOW) {
+                std::cerr << "shader_sdfbake needs an offscreen backend (egl or osmesa): " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--shaders") {
+            options.shaderDir = value;
+        } else if (arg == "--cache-dir") {
+            options.cacheDir = value;
+        } else if (arg == "--shader") {
+            options.shader = std::atoi(value.c_str());
+            if (options.shader < 1) {
+                std::cerr << "--shader expects a shader number from 1" << std::endl;
+                return false;
+            }
+        } else if (arg == "--bounds") {
+            float* minCorner = options.settings.boundsMin;
+            float* maxCorner = options.settings.boundsMax;
+            if (std::sscanf(value.c_str(), "%f,%f,%f,%f,%f,%f", &minCorner[0], &minCorner[1], &minCorner[2],
+                            &maxCorner[0], &maxCorner[1], &maxCorner[2]) != 6 ||
+                maxCorner[0] <= minCorner[0] || maxCorner[1] <= minCorner[1] || maxCorner[2] <= minCorner[2]) {
+                std::cerr << "--bounds expects x0,y0,z0,x1,y1,z1 with the second corner above the first" << std::endl;
+                return false;
+            }
+            options.overrideBounds = true;
+        } else if (arg == "--resolution") {
+            options.settings.resolution = std::atoi(value.c_str());
+            if (options.settings.resolution < 2 || options.settings.resolution > 512) {
+                std::cerr << "--resolution expects 2-512" << std::endl;
+                return false;
+            }
+            options.overrideResolution = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printSdfBakeUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SdfBakeOptions options;
+    if (!parseSdfBakeOptions(argc, argv, options)) {
+        return 1;
+    }
+    uint64_t startNs = traceNowNs();
+
+    std::unique_ptr<RenderBackend> backend;
+    GLuint quadVAO = 0;
+    int baked = 0, cached = 0, failed = 0;
+    for (int index = 1; ; index++) {
+        std::string name = "shader" + std::to_string(index);
+        std::ifstream probe(options.shaderDir + "/" + name + ".glsl");
+        if (!probe.good()) {
+            break;
+        }
+        probe.close();
+        if (options.shader != 0 && options.shader != index) {
+            continue;
+        }
+        std::string code = loadShaderFromFile(options.shaderDir + "/" + name + ".glsl");
+        if (!shaderHasStaticSdf(code)) {
+            continue;
+        }
+        SdfBakeSettings settings;
+        if (!parseSdfBounds(code, settings) && !options.overrideBounds) {
+            std::cout << "FAIL    " << name << " (no sdf-bounds line and no --bounds)" << std::endl;
+            failed++;
+            continue;
+        }
+        if (options.overrideBounds) {
+            std::copy(options.settings.boundsMin, options.settings.boundsMin + 3, settings.boundsMin);
+            std::copy(options.settings.boundsMax, options.settings.boundsMax + 3, settings.boundsMax);
+        }
+        if (options.overrideResolution) {
+            settings.resolution = options.settings.resolution;
+        }
+
+        // The same source baked with the same settings is current
+        std::string cachePath = getSdfCachePath(options.cacheDir, name);
+        SdfVolume volume;
+        if (!options.force && loadSdfVolume(cachePath, hashSource(code), volume) && volume.settings == settings) {
+            std::printf("cached  %-10s %dx%dx%d\n", name.c_str(), volume.size[0], volume.size[1], volume.size[2]);
+            cached++;
+            continue;
+        }
+
+        if (!backend) {
+            backend = createRenderBackend(options.backend);
+            if (!backend || !backend->init("shader_sdfbake", 64, 64)) {
+                std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
+                return 1;
+            }
+            quadVAO = createFullScreenQuad();
+        }
+        uint64_t bakeStartNs = traceNowNs();
+        if (!bakeSdfVolume(code, settings, quadVAO, volume) || !saveSdfVolume(cachePath, volume)) {
+            std::cout << "FAIL    " << name << " (bake)" << std::endl;
+            failed++;
+            continue;
+        }
+        std::printf("baked   %-10s %dx%dx%d, voxel %.3f, %.1f MB in %.0f ms\n", name.c_str(), volume.size[0],
+                    volume.size[1], volume.size[2], volume.voxelSize,
+                    volume.distances.size() * sizeof(float) / (1024.0 * 1024.0), (traceNowNs() - bakeStartNs) / 1e6);
+        baked++;
+    }
+    if (quadVAO) {
+        glDeleteVertexArrays(1, &quadVAO);
+    }
+
+    std::cout << baked << " baked, " << cached << " cached, " << failed << " failed ("
+              << (traceNowNs() - startNs) / 1e6 << " ms)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
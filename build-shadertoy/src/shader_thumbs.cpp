@@ -0,0 +1,295 @@
+// shader_thumbs: keeps a preview image of every shader in ../shaders in a single
+// cache file. Only shaders whose source (or knobs, or size) changed are rendered.
+// Each of those is drawn once per candidate iTime into its row of an atlas with one
+// program bind; the atlas is read back once and the busiest candidate is kept.
+#include "../include/shader_manager.h"
+#include "../include/includes.h"
+#include "../include/backend.h"
+#include "../include/file_io.h"
+#include "../include/image_io.h"
+#include "../include/render_target.h"
+#include "../include/thumbnail_cache.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Upper bound for the atlas height; more shaders are rendered in several batches
+const int THUMBNAIL_ATLAS_MAX_HEIGHT = 4096;
+
+struct ThumbOptions {
+    BackendType backend = BACKEND_EGL;
+    std::string shaderDir = "../shaders";
+    std::string cachePath = "../thumbnails.cache";
+    std::string exportDir;          // Also write every thumbnail as <dir>/shaderN.ppm
+    int width = 160;
+    int height = 90;
+    std::vector<float> times = {2.0f, 5.0f, 10.0f, 20.0f};
+    bool fullQuality = false;       // Skip the low-quality knobs
+    bool force = false;             // Ignore the cache
+};
+
+// A shader that needs a new thumbnail
+struct ThumbRequest {
+    std::string name;
+    std::string code;
+    ShaderDefines defines;
+    uint64_t hash;
+};
+
+static void printThumbsUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "  --backend <name>        egl (default) or osmesa" << std::endl;
+    std::cout << "  --shaders <dir>         Directory with shader1.glsl, ... (default ../shaders)" << std::endl;
+    std::cout << "  --cache <file>          Thumbnail cache file (default ../thumbnails.cache)" << std::endl;
+    std::cout << "  --size <WxH>            Thumbnail size (default 160x90)" << std::endl;
+    std::cout << "  --times <list>          Candidate iTime values, the busiest image wins (default 2,5,10,20)" << std::endl;
+    std::cout << "  --full-quality          Render without the low-quality knobs" << std::endl;
+    std::cout << "  --export <dir>          Also write the thumbnails as PPM files" << std::endl;
+    std::cout << "  --force                 Render every shader again" << std::endl;
+}
+
+static bool parseThumbsOptions(int argc, char* argv[], ThumbOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--full-quality" || arg == "--force") {
+            (arg == "--force" ? options.force : options.fullQuality) = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            }
+            printThumbsUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--backend") {
+            if (!parseBackendType(value, options.backend) || options.backend == BACKEND_WINDOW) {
+                std::cerr << "shader_thumbs needs an offscreen backend (egl or osmesa): " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--shaders") {
+            options.shaderDir = value;
+        } else if (arg == "--cache") {
+            options.cachePath = value;
+        } else if (arg == "--export") {
+            options.exportDir = value;
+        } else if (arg == "--size") {
+            if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width < 1 || options.height < 1 || options.width > 1024 || options.height > 1024) {
+                std::cerr << "--size expects WIDTHxHEIGHT up to 1024x1024" << std::endl;
+                return false;
+            }
+        } else if (arg == "--times") {
+            options.times.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                options.times.push_back(static_cast<float>(std::atof(item.c_str())));
+            }
+            if (options.times.empty()) {
+                std::cerr << "--times expects a comma separated list" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printThumbsUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Standard deviation of the luma of one atlas cell; flat or black frames score low
+static float scoreCell(const std::vector<unsigned char>& atlas, int atlasWidth, int cellX, int cellY,
+                       int width, int height) {
+    double sum = 0.0, sumSquares = 0.0;
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = atlas.data() + (static_cast<size_t>(cellY + y) * atlasWidth + cellX) * 4;
+        for (int x = 0; x < width; x++) {
+            double luma = 0.299 * row[x * 4] + 0.587 * row[x * 4 + 1] + 0.114 * row[x * 4 + 2];
+            sum += luma;
+            sumSquares += luma * luma;
+        }
+    }
+    double count = static_cast<double>(width) * height;
+    double mean = sum / count;
+    return static_cast<float>(std::sqrt(std::max(0.0, sumSquares / count - mean * mean)));
+}
+
+int main(int argc, char* argv[]) {
+    ThumbOptions options;
+    if (!parseThumbsOptions(argc, argv, options)) {
+        return 1;
+    }
+    uint64_t startNs = traceNowNs();
+
+    ThumbnailCache cache;
+    if (!options.force) {
+        cache.load(options.cachePath);
+    }
+
+    // Everything the image depends on goes into the key
+    std::string settingsKey = "v" + std::to_string(THUMBNAIL_CACHE_VERSION) + " " + std::to_string(options.width) +
+                              "x" + std::to_string(options.height);
+    for (float time : options.times) {
+        settingsKey += " " + std::to_string(time);
+    }
+
+    std::vector<ThumbRequest> requests;
+    std::vector<std::string> present;
+    for (int index = 1; ; index++) {
+        std::string name = "shader" + std::to_string(index);
+        std::ifstream probe(options.shaderDir + "/" + name + ".glsl");
+        if (!probe.good()) {
+            break;
+        }
+        probe.close();
+        present.push_back(name);
+        ThumbRequest request;
+        request.name = name;
+        request.code = loadShaderFromFile(options.shaderDir + "/" + name + ".glsl");
+        if (!options.fullQuality && index <= static_cast<int>(SHADER_LOW_QUALITY_DEFINES.size())) {
+            request.defines = SHADER_LOW_QUALITY_DEFINES[index - 1];
+        }
+        std::string key = settingsKey;
+        for (const auto& knob : request.defines) {
+            key += " " + knob.first + "=" + knob.second;
+        }
+        request.hash = hashSource(key + "\n" + request.code);
+        if (!cache.find(name, request.hash)) {
+            requests.push_back(request);
+        }
+    }
+    // Shaders that no longer exist drop out of the cache
+    std::vector<std::string> stale;
+    for (const auto& entry : cache.getEntries()) {
+        if (std::find(present.begin(), present.end(), entry.first) == present.end()) {
+            stale.push_back(entry.first);
+        }
+    }
+    for (const std::string& name : stale) {
+        cache.remove(name);
+    }
+    std::cout << present.size() << " shaders, " << present.size() - requests.size() << " cached, "
+              << requests.size() << " to render" << std::endl;
+
+    int failed = 0;
+    if (!requests.empty()) {
+        std::unique_ptr<RenderBackend> backend = createRenderBackend(options.backend);
+        if (!backend || !backend->init("shader_thumbs", options.width, options.height)) {
+            std::cerr << "Failed to initialize the " << getBackendName(options.backend) << " backend!" << std::endl;
+            return 1;
+        }
+        GLuint quadVAO = createFullScreenQuad();
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+        int columns = static_cast<int>(options.times.size());
+        int atlasWidth = options.width * columns;
+        int rowsPerBatch = std::max(1, std::min(THUMBNAIL_ATLAS_MAX_HEIGHT, static_cast<int>(maxSize)) / options.height);
+        if (atlasWidth > maxSize) {
+            std::cerr << "Too many candidate times for a " << maxSize << " pixel wide atlas" << std::endl;
+            return 1;
+        }
+
+        RenderTarget atlas;
+        for (size_t first = 0; first < requests.size(); first += rowsPerBatch) {
+            size_t last = std::min(requests.size(), first + rowsPerBatch);
+            int rows = static_cast<int>(last - first);
+            if (!atlas.resize(atlasWidth, options.height * rows)) {
+                std::cerr << "Cannot allocate the thumbnail atlas" << std::endl;
+                return 1;
+            }
+            atlas.bind();
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glBindVertexArray(quadVAO);
+            std::vector<bool> compiled(rows, false);
+            for (int row = 0; row < rows; row++) {
+                ThumbRequest& request = requests[first + row];
+                ShaderManager shader;
+                compiled[row] = !request.code.empty() &&
+                    shader.loadFromStrings(defaultVertexShader, createShaderToyFragmentShader(request.code, request.defines));
+                if (!compiled[row]) {
+                    std::cout << "FAIL    " << request.name << " (compile)" << std::endl;
+                    failed++;
+                    continue;
+                }
+                // One bind, then only the viewport and the time change; the atlas row is
+                // counted from the top so it matches the pixels read back
+                TRACE_SCOPE("thumbnail row");
+                shader.use();
+                int viewportY = options.height * (rows - 1 - row);
+                for (int column = 0; column < columns; column++) {
+                    glViewport(column * options.width, viewportY, options.width, options.height);
+                    float time = options.times[column];
+                    shader.setupShaderToyUniforms(options.width, options.height, time, 1.0f / 60.0f,
+                                                  static_cast<int>(time * 60.0f), 0, options.height, false);
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                }
+            }
+            glBindVertexArray(0);
+
+            std::vector<unsigned char> pixels;
+            if (!readFramebufferRGBA(atlas.getFramebuffer(), atlasWidth, options.height * rows, pixels)) {
+                return 1;
+            }
+            for (int row = 0; row < rows; row++) {
+                if (!compiled[row]) {
+                    continue;
+                }
+                const ThumbRequest& request = requests[first + row];
+                int best = 0;
+                float bestScore = -1.0f;
+                for (int column = 0; column < columns; column++) {
+                    float score = scoreCell(pixels, atlasWidth, column * options.width, row * options.height,
+                                            options.width, options.height);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = column;
+                    }
+                }
+                Thumbnail thumbnail;
+                thumbnail.name = request.name;
+                thumbnail.sourceHash = request.hash;
+                thumbnail.time = options.times[best];
+                thumbnail.width = options.width;
+                thumbnail.height = options.height;
+                thumbnail.rgb.resize(static_cast<size_t>(options.width) * options.height * 3);
+                for (int y = 0; y < options.height; y++) {
+                    const unsigned char* source = pixels.data() +
+                        (static_cast<size_t>(row * options.height + y) * atlasWidth + best * options.width) * 4;
+                    unsigned char* target = thumbnail.rgb.data() + static_cast<size_t>(y) * options.width * 3;
+                    for (int x = 0; x < options.width; x++) {
+                        target[x * 3 + 0] = source[x * 4 + 0];
+                        target[x * 3 + 1] = source[x * 4 + 1];
+                        target[x * 3 + 2] = source[x * 4 + 2];
+                    }
+                }
+                cache.put(thumbnail);
+                std::printf("rendered %-10s iTime %.1f (contrast %.1f)\n", request.name.c_str(), thumbnail.time, bestScore);
+            }
+        }
+        atlas.release();
+        glDeleteVertexArrays(1, &quadVAO);
+    }
+
+    if ((!requests.empty() || !stale.empty() || options.force) && !cache.save(options.cachePath)) {
+        return 1;
+    }
+    if (!options.exportDir.empty()) {
+        for (const auto& entry : cache.getEntries()) {
+            const Thumbnail& thumbnail = entry.second;
+            std::vector<unsigned char> rgba(static_cast<size_t>(thumbnail.width) * thumbnail.height * 4, 255);
+            for (size_t i = 0; i < static_cast<size_t>(thumbnail.width) * thumbnail.height; i++) {
+                std::copy(thumbnail.rgb.begin() + i * 3, thumbnail.rgb.begin() + i * 3 + 3, rgba.begin() + i * 4);
+            }
+            writePPM(options.exportDir + "/" + entry.first + ".ppm", thumbnail.width, thumbnail.height, rgba);
+        }
+    }
+    std::cout << "Thumbnail cache " << options.cachePath << ": " << cache.getEntries().size() << " entries ("
+              << (traceNowNs() - startNs) / 1e6 << " ms)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -1,5 +1,65 @@
 #include "../include/shader_manager.h"
 
+// Quality knobs of the low-quality variant used by the watchdog and for previews, per
+// shader. Shaders without knobs get a further reduced render scale instead.
+const std::vector<ShaderDefines> SHADER_LOW_QUALITY_DEFINES = {
+    {},
+    {},
+    {},
+    {{"AA", "1"}},
+    {},
+    {{"NUM_STEPS", "16"}, {"ITER_GEOMETRY", "2"}, {"ITER_FRAGMENT", "3"}},
+    {},
+    {{"AA", "1"}},
+    {{"RAYMARCH_ITERATIONS", "24"}, {"SHADOW_ITERATIONS", "16"}},
+    {{"MaxSteps", "18"}, {"Iterations", "5"}},
+    {}
+};
+
+// Knobs between the source as written and the low-quality variant, for shaders
+// whose knobs have a useful middle ground (the quality governor's levels)
+const std::vector<ShaderDefines> SHADER_MEDIUM_QUALITY_DEFINES = {
+    {},
+    {},
+    {},
+    {},
+    {},
+    {{"NUM_STEPS", "24"}, {"ITER_FRAGMENT", "4"}},
+    {},
+    {},
+    {{"RAYMARCH_ITERATIONS", "32"}, {"SHADOW_ITERATIONS", "32"}},
+    {{"MaxSteps", "24"}, {"Iterations", "6"}},
+    {}
+};
+
+// Knobs that turn off a shader's own supersampling, for progressive accumulation
+const std::vector<ShaderDefines> SHADER_SINGLE_SAMPLE_DEFINES = {
+    {},
+    {},
+    {},
+    {{"AA", "1"}},
+    {},
+    {},
+    {},
+    {{"AA", "1"}},
+    {},
+    {},
+    {}
+};
+
+std::vector<ShaderDefines> getShaderQualityLevels(int shader) {
+    std::vector<ShaderDefines> levels(1);
+    if (shader >= 0 && shader < static_cast<int>(SHADER_LOW_QUALITY_DEFINES.size())) {
+        if (!SHADER_MEDIUM_QUALITY_DEFINES[shader].empty()) {
+            levels.push_back(SHADER_MEDIUM_QUALITY_DEFINES[shader]);
+        }
+        if (!SHADER_LOW_QUALITY_DEFINES[shader].empty()) {
+            levels.push_back(SHADER_LOW_QUALITY_DEFINES[shader]);
+        }
+    }
+    return levels;
+}
+
 
 // Default vertex shader for ShaderToy-style rendering
 const char* defaultVertexShader = R"(
@@ -36,8 +96,79 @@ const char* shaderToyWrapper = R"(
     }
 )";
 
+// Function to load shader code from a file
+std::string loadShaderFromFile(const std::string& filePath) {
+    std::string shaderCode;
+    std::ifstream shaderFile;
+    // Ensure ifstream objects can throw exceptions
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try {
+        // Open file
+        shaderFile.open(filePath);
+        std::stringstream shaderStream;
+        // Read file's buffer contents into stream
+        shaderStream << shaderFile.rdbuf();
+        // Close file
+        shaderFile.close();
+        // Convert stream into string
+        shaderCode = shaderStream.str();
+    }
+    catch (std::ifstream::failure& e) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << filePath << std::endl;
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return "";
+    }
+    return shaderCode;
+}
+
+// Function to override quality knobs in a ShaderToy source
+std::string applyShaderDefines(const std::string& shaderToyCode, const ShaderDefines& defines) {
+    if (defines.empty()) {
+        return shaderToyCode;
+    }
+    std::map<std::string, bool> applied;
+    std::stringstream input(shaderToyCode);
+    std::string result;
+    std::string line;
+    while (std::getline(input, line)) {
+        std::stringstream tokens(line);
+        std::string first, second, third;
+        tokens >> first >> second >> third;
+
+        // "#define NAME value" - replaced inside #if branches too, so every branch agrees
+        if (first == "#define" && defines.count(second)) {
+            line = "#define " + second + " " + defines.at(second);
+            applied[second] = true;
+        }
+        // "const type NAME = value;"
+        else if (first == "const" && defines.count(third) && line.find('=') != std::string::npos) {
+            line = "const " + second + " " + third + " = " + defines.at(third) + ";";
+            applied[third] = true;
+        }
+        result += line + "\n";
+    }
+
+    std::string prelude;
+    for (const auto& define : defines) {
+        if (!applied[define.first]) {
+            prelude += "#define " + define.first + " " + define.second + "\n";
+        }
+    }
+    return prelude + result;
+}
+
+// Function to build the key of a define set (std::map keeps the names sorted)
+std::string getShaderDefinesKey(const ShaderDefines& defines) {
+    std::string key;
+    for (const auto& define : defines) {
+        key += (key.empty() ? "" : " ") + define.first + "=" + define.second;
+    }
+    return key;
+}
+
 // Create a ShaderToy-compatible fragment shader
-std::string createShaderToyFragmentShader(const std::string& shaderToyCode) {
+std::string createShaderToyFragmentShader(const std::string& shaderToyCode, const ShaderDefines& defines,
+                                          const char* mainSource) {
     std::string wrapper = R"(
         #version 330 core
         in vec2 fragCoord;
@@ -48,16 +179,97 @@ std::string createShaderToyFragmentShader(const std::string& shaderToyCode) {
         uniform float iTimeDelta;
         uniform int iFrame;
         uniform vec4 iMouse;
+        uniform vec4 iTile;         // Tiled render: pixel offset (xy) and size (zw) of the tile, 0 = whole frame
+        uniform vec2 iJitter;       // Progressive accumulation: sample offset within the pixel, 0 = centre
+        uniform vec4 iInterleave;   // Interleaved render: pixel stride (xy) and offset (zw) of the shaded pixels, 0 = all
+        uniform vec2 iPrepass;      // Depth prepass: mode (x: 1 = prepass, 2 = full pass using it, 0 = off), block size (y)
+        uniform sampler2D iPrepassDepth;
+
+        // Depth prepass hook for ray marchers. A shader opts in by starting its primary
+        // march at shadertoyRayStart(tmin); while shadertoyPrepass() is true it advances
+        // with shadertoyConeStep (false = stop), passes the distance reached to
+        // shadertoyPrepassResult and may skip its shading.
+        vec2 shadertoyPixel;
+        vec2 shadertoyPrepassOut = vec2(0.0);
+
+        bool shadertoyPrepass() {
+            return iPrepass.x == 1.0;
+        }
+
+        // Where the ray of this pixel may start: no surface of its block is nearer
+        float shadertoyRayStart(float tmin) {
+            if (iPrepass.x != 2.0) {
+                return tmin;
+            }
+            return max(tmin, texelFetch(iPrepassDepth, ivec2(shadertoyPixel / iPrepass.y), 0).x);
+        }
+
+        // Plain march steps the prepass took to get there, for shaders that shade by step count
+        float shadertoyRaySteps() {
+            return iPrepass.x == 2.0 ? texelFetch(iPrepassDepth, ivec2(shadertoyPixel / iPrepass.y), 0).y : 0.0;
+        }
+
+        // Advance t along the block's central ray, d being the scene distance at t, so that
+        // the cone around it stays clear. pixelAngle is the angle between neighbouring pixels'
+        // rays, slackAngle any extra per-pixel spread (sample jitter).
+        bool shadertoyConeStep(inout float t, float d, float pixelAngle, float slackAngle) {
+            // Half the block diagonal, plus a pixel for subsamples and ray differentials
+            float cone = pixelAngle * (0.7072 * iPrepass.y + 1.0) + slackAngle;
+            if (d <= cone * t) {
+                return false;
+            }
+            float next = (t + d) / (1.0 + cone);
+            shadertoyPrepassOut.y += (next - t) / d;
+            t = next;
+            return true;
+        }
+
+        void shadertoyPrepassResult(float t) {
+            shadertoyPrepassOut.x = t;
+        }
+
+        // Baked distance volume of a shader's static SHADERTOY_STATIC_SDF(p) (shader_sdfbake)
+        uniform sampler3D iSdfVolume;
+        uniform vec4 iSdfBoundsMin;     // xyz: volume corner, w: 1 = a volume is bound
+        uniform vec4 iSdfBoundsMax;     // xyz: opposite corner, w: largest sampling error (voxel diagonal)
+
+        // Lower bound of the static distance at p, for far-field steps. 0 without a volume,
+        // outside it and near surfaces (within two errors), where a march needs the exact SDF.
+        float shadertoyBakedDistance(vec3 p) {
+            if (iSdfBoundsMin.w == 0.0 || any(lessThan(p, iSdfBoundsMin.xyz)) || any(greaterThan(p, iSdfBoundsMax.xyz))) {
+                return 0.0;
+            }
+            // Samples sit on the grid nodes, corner to corner
+            vec3 size = vec3(textureSize(iSdfVolume, 0));
+            vec3 uvw = ((p - iSdfBoundsMin.xyz) / (iSdfBoundsMax.xyz - iSdfBoundsMin.xyz) * (size - 1.0) + 0.5) / size;
+            float d = textureLod(iSdfVolume, uvw, 0.0).x - iSdfBoundsMax.w;
+            return d > iSdfBoundsMax.w ? d : 0.0;
+        }
         
         // ShaderToy code
         )";
         
-    wrapper += shaderToyCode;
+    wrapper += applyShaderDefines(shaderToyCode, defines);
+    if (mainSource) {
+        return wrapper + mainSource;
+    }
     
     wrapper += R"(
         
         void main() {
-            mainImage(fragColor, fragCoord * iResolution.xy);
+            vec2 tileSize = iTile.z > 0.0 ? iTile.zw : iResolution.xy;
+            vec2 pixel = iTile.xy + fragCoord * tileSize + iJitter;
+            if (iInterleave.x > 0.0) {
+                // One texel per stride cell; with a 2x1 stride the offset alternates per row
+                vec2 cell = floor(gl_FragCoord.xy);
+                vec2 offset = iInterleave.y > 1.0 ? iInterleave.zw : vec2(mod(cell.y + iInterleave.z, 2.0), 0.0);
+                pixel = cell * iInterleave.xy + offset + 0.5;
+            }
+            shadertoyPixel = pixel;
+            mainImage(fragColor, pixel);
+            if (iPrepass.x == 1.0) {
+                fragColor = vec4(shadertoyPrepassOut, 0.0, 1.0);
+            }
         }
     )";
     
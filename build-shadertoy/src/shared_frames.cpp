@@ -0,0 +1,271 @@
+#include "../include/shared_frames.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+static const char SHARED_FRAMES_MAGIC[8] = {'S', 'T', 'F', 'R', 'A', 'M', 'E', 'S'};
+
+#ifdef __linux__
+// Shared (not process-private) futex, so waiters in other processes are found
+static void futexWakeAll(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static void futexWait(const std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+    timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+#endif
+
+SharedFrameWriter::SharedFrameWriter()
+    : header(nullptr), slots(nullptr), data(nullptr), mappedBytes(0), sequence(0), published(0), skipped(0) {
+}
+
+SharedFrameWriter::~SharedFrameWriter() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool SharedFrameWriter::open(const std::string& objectName, int, int, int) {
+    std::cerr << "Shared-memory output needs a POSIX system (shm_open): " << objectName << std::endl;
+    return false;
+}
+
+bool SharedFrameWriter::publish(const std::vector<unsigned char>&, int, int, uint64_t) {
+    return false;
+}
+
+void SharedFrameWriter::close() {
+}
+
+SharedFrameReader::SharedFrameReader() : header(nullptr), mappedBytes(0), lastSequence(0), slotSequence(0) {
+}
+
+SharedFrameReader::~SharedFrameReader() {
+}
+
+bool SharedFrameReader::open(const std::string&) {
+    return false;
+}
+
+void SharedFrameReader::close() {
+}
+
+bool SharedFrameReader::waitFrame(int, const SharedFrameSlot*&, const unsigned char*&) {
+    return false;
+}
+
+bool SharedFrameReader::isStillValid(const SharedFrameSlot*) const {
+    return false;
+}
+
+bool SharedFrameReader::isWriterAlive() const {
+    return false;
+}
+
+#else
+
+bool SharedFrameWriter::open(const std::string& objectName, int maxWidth, int maxHeight, int slotCount) {
+    close();
+    name = objectName;
+    slotCount = std::max(2, slotCount);
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uint64_t slotBytes = (static_cast<uint64_t>(maxWidth) * maxHeight * 4 + pageSize - 1) / pageSize * pageSize;
+    size_t headerBytes = sizeof(SharedFrameRingHeader) + slotCount * sizeof(SharedFrameSlot);
+    uint64_t dataOffset = (headerBytes + pageSize - 1) / pageSize * pageSize;
+    mappedBytes = static_cast<size_t>(dataOffset + slotBytes * slotCount);
+
+    // A stale object from a crashed run is replaced
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR::SHARED_FRAMES::SHM_OPEN_FAILED: " << name << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(mappedBytes)) == 0) {
+        mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "ERROR::SHARED_FRAMES::MAP_FAILED: " << name << " (" << std::strerror(errno) << ")" << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // Fresh pages are zero, so every atomic starts at 0
+    header = static_cast<SharedFrameRingHeader*>(mapping);
+    slots = reinterpret_cast<SharedFrameSlot*>(header + 1);
+    data = static_cast<unsigned char*>(mapping) + dataOffset;
+    header->version = SHARED_FRAMES_VERSION;
+    header->slotCount = static_cast<uint32_t>(slotCount);
+    header->slotBytes = slotBytes;
+    header->dataOffset = dataOffset;
+    header->writerAlive.store(1, std::memory_order_relaxed);
+    // The magic goes in last: a reader that sees it sees a complete header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, SHARED_FRAMES_MAGIC, sizeof(SHARED_FRAMES_MAGIC));
+    sequence = 0;
+    published = 0;
+    skipped = 0;
+    std::cout << "Publishing frames to shared memory " << name << " (" << slotCount << " slots of "
+              << slotBytes / 1024 << " KiB)" << std::endl;
+    return true;
+}
+
+bool SharedFrameWriter::publish(const std::vector<unsigned char>& pixels, int width, int height, uint64_t frameIndex) {
+    if (!header) {
+        return false;
+    }
+    uint64_t bytes = static_cast<uint64_t>(width) * height * 4;
+    if (bytes > header->slotBytes || pixels.size() < bytes) {
+        skipped++;
+        return false;
+    }
+    TRACE_SCOPE("shm publish");
+    uint32_t next = sequence + 1;
+    uint32_t slotIndex = next % header->slotCount;
+    SharedFrameSlot& slot = slots[slotIndex];
+
+    // Odd while writing; readers that started on this slot will see the change
+    slot.sequence.store(static_cast<uint64_t>(next) * 2 - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data + slotIndex * header->slotBytes, pixels.data(), static_cast<size_t>(bytes));
+    slot.timestampNs = traceNowNs();
+    slot.frameIndex = frameIndex;
+    slot.width = static_cast<uint32_t>(width);
+    slot.height = static_cast<uint32_t>(height);
+    slot.stride = static_cast<uint32_t>(width) * 4;
+    slot.format = SHARED_FRAMES_FORMAT_RGBA8;
+    slot.bytes = static_cast<uint32_t>(bytes);
+    slot.sequence.store(static_cast<uint64_t>(next) * 2, std::memory_order_release);
+
+    header->latestSlot = slotIndex;
+    header->latestSequence.store(next, std::memory_order_release);
+#ifdef __linux__
+    futexWakeAll(&header->latestSequence);
+#endif
+    sequence = next;
+    published++;
+    return true;
+}
+
+void SharedFrameWriter::close() {
+    if (!header) {
+        return;
+    }
+    // Sleeping readers wake up and see the writer is gone
+    header->writerAlive.store(0, std::memory_order_release);
+#ifdef __linux__
+    futexWakeAll(&header->latestSequence);
+#endif
+    munmap(header, mappedBytes);
+    // Readers that still have it mapped keep their mapping
+    shm_unlink(name.c_str());
+    header = nullptr;
+    slots = nullptr;
+    data = nullptr;
+}
+
+SharedFrameReader::SharedFrameReader() : header(nullptr), mappedBytes(0), lastSequence(0), slotSequence(0) {
+}
+
+SharedFrameReader::~SharedFrameReader() {
+    close();
+}
+
+bool SharedFrameReader::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SharedFrameRingHeader)) {
+        mappedBytes = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    header = static_cast<const SharedFrameRingHeader*>(mapping);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(header->magic, SHARED_FRAMES_MAGIC, sizeof(SHARED_FRAMES_MAGIC)) != 0 ||
+        header->version != SHARED_FRAMES_VERSION ||
+        header->dataOffset + header->slotBytes * header->slotCount > mappedBytes) {
+        close();
+        return false;
+    }
+    lastSequence = header->latestSequence.load(std::memory_order_acquire);
+    return true;
+}
+
+void SharedFrameReader::close() {
+    if (header) {
+        munmap(const_cast<SharedFrameRingHeader*>(header), mappedBytes);
+        header = nullptr;
+    }
+}
+
+bool SharedFrameReader::waitFrame(int timeoutMs, const SharedFrameSlot*& slot, const unsigned char*& pixels) {
+    if (!header) {
+        return false;
+    }
+    uint32_t latest = header->latestSequence.load(std::memory_order_acquire);
+    if (latest == lastSequence && isWriterAlive()) {
+#ifdef __linux__
+        futexWait(&header->latestSequence, lastSequence, timeoutMs);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeoutMs, 1)));
+#endif
+        latest = header->latestSequence.load(std::memory_order_acquire);
+    }
+    if (latest == lastSequence) {
+        return false;
+    }
+    const SharedFrameSlot* candidate = reinterpret_cast<const SharedFrameSlot*>(header + 1) +
+                                       latest % header->slotCount;
+    uint64_t sequence = candidate->sequence.load(std::memory_order_acquire);
+    if (sequence != static_cast<uint64_t>(latest) * 2) {
+        // Already being overwritten; the caller simply waits for the next one
+        lastSequence = latest;
+        return false;
+    }
+    lastSequence = latest;
+    slotSequence = sequence;
+    slot = candidate;
+    pixels = reinterpret_cast<const unsigned char*>(header) + header->dataOffset +
+             (latest % header->slotCount) * header->slotBytes;
+    return true;
+}
+
+bool SharedFrameReader::isStillValid(const SharedFrameSlot* slot) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot && slot->sequence.load(std::memory_order_relaxed) == slotSequence;
+}
+
+bool SharedFrameReader::isWriterAlive() const {
+    return header && header->writerAlive.load(std::memory_order_acquire) != 0;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "../include/thumbnail_cache.h"
+#include "../include/file_io.h"
+#include <cstdio>
+#include <cstring>
+
+// File layout (little-endian, as written by the host):
+//   char[8]  "STTHUMBS"
+//   uint32   version, entry count
+//   entries: uint16 name length, name, uint64 hash, float time,
+//            uint32 width, height, uint64 pixel offset (from the file start)
+//   pixel blocks, width * height * 3 bytes each
+static const char THUMBNAIL_MAGIC[8] = {'S', 'T', 'T', 'H', 'U', 'M', 'B', 'S'};
+
+struct ThumbnailIndexEntry {
+    std::string name;
+    uint64_t hash;
+    float time;
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+};
+
+// Bytes of an index entry with an empty name
+const long THUMBNAIL_MIN_ENTRY_SIZE = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(float) + 2 * sizeof(uint32_t) +
+                                      sizeof(uint64_t);
+
+// Function to read the header and index; leaves the file positioned after the index
+static bool readIndex(std::FILE* file, std::vector<ThumbnailIndexEntry>& index) {
+    // The count comes from the file: a damaged one must not size the index beyond the file
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long fileSize = std::ftell(file);
+    std::rewind(file);
+    char magic[8];
+    uint32_t version = 0, count = 0;
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        std::memcmp(magic, THUMBNAIL_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(file, version) || version != THUMBNAIL_CACHE_VERSION || !readValue(file, count) ||
+        fileSize < 0 || count > static_cast<unsigned long>(fileSize / THUMBNAIL_MIN_ENTRY_SIZE)) {
+        return false;
+    }
+    index.resize(count);
+    for (ThumbnailIndexEntry& entry : index) {
+        uint16_t nameLength = 0;
+        if (!readValue(file, nameLength)) {
+            return false;
+        }
+        entry.name.resize(nameLength);
+        if ((nameLength > 0 && std::fread(&entry.name[0], 1, nameLength, file) != nameLength) ||
+            !readValue(file, entry.hash) || !readValue(file, entry.time) || !readValue(file, entry.width) ||
+            !readValue(file, entry.height) || !readValue(file, entry.offset) ||
+            entry.width == 0 || entry.height == 0 || entry.width > 4096 || entry.height > 4096) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readPixels(std::FILE* file, const ThumbnailIndexEntry& entry, Thumbnail& thumbnail) {
+    thumbnail.name = entry.name;
+    thumbnail.sourceHash = entry.hash;
+    thumbnail.time = entry.time;
+    thumbnail.width = static_cast<int>(entry.width);
+    thumbnail.height = static_cast<int>(entry.height);
+    thumbnail.rgb.resize(static_cast<size_t>(entry.width) * entry.height * 3);
+    return std::fseek(file, static_cast<long>(entry.offset), SEEK_SET) == 0 &&
+           std::fread(thumbnail.rgb.data(), 1, thumbnail.rgb.size(), file) == thumbnail.rgb.size();
+}
+
+bool ThumbnailCache::load(const std::string& filePath) {
+    entries.clear();
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return true;
+    }
+    std::vector<ThumbnailIndexEntry> index;
+    bool ok = readIndex(file, index);
+    for (size_t i = 0; ok && i < index.size(); i++) {
+        Thumbnail thumbnail;
+        ok = readPixels(file, index[i], thumbnail);
+        entries[thumbnail.name] = thumbnail;
+    }
+    std::fclose(file);
+    if (!ok) {
+        std::cerr << "ERROR::THUMBNAILS::BAD_CACHE (rebuilding): " << filePath << std::endl;
+        entries.clear();
+    }
+    return ok;
+}
+
+bool ThumbnailCache::save(const std::string& filePath) const {
+    return saveFileAtomically(filePath, "THUMBNAILS", "wb", [this](std::FILE* file) {
+        // The pixel blocks start after the index, so its size is worked out first
+        uint64_t offset = sizeof(THUMBNAIL_MAGIC) + 2 * sizeof(uint32_t);
+        for (const auto& entry : entries) {
+            offset += sizeof(uint16_t) + entry.first.size() + sizeof(uint64_t) + sizeof(float) +
+                      2 * sizeof(uint32_t) + sizeof(uint64_t);
+        }
+        std::fwrite(THUMBNAIL_MAGIC, 1, sizeof(THUMBNAIL_MAGIC), file);
+        writeValue(file, THUMBNAIL_CACHE_VERSION);
+        writeValue(file, static_cast<uint32_t>(entries.size()));
+        for (const auto& entry : entries) {
+            const Thumbnail& thumbnail = entry.second;
+            writeValue(file, static_cast<uint16_t>(thumbnail.name.size()));
+            std::fwrite(thumbnail.name.data(), 1, thumbnail.name.size(), file);
+            writeValue(file, thumbnail.sourceHash);
+            writeValue(file, thumbnail.time);
+            writeValue(file, static_cast<uint32_t>(thumbnail.width));
+            writeValue(file, static_cast<uint32_t>(thumbnail.height));
+            writeValue(file, offset);
+            offset += thumbnail.rgb.size();
+        }
+        for (const auto& entry : entries) {
+            std::fwrite(entry.second.rgb.data(), 1, entry.second.rgb.size(), file);
+        }
+    });
+}
+
+const Thumbnail* ThumbnailCache::find(const std::string& name, uint64_t sourceHash) const {
+    std::map<std::string, Thumbnail>::const_iterator entry = entries.find(name);
+    if (entry == entries.end() || entry->second.sourceHash != sourceHash) {
+        return nullptr;
+    }
+    return &entry->second;
+}
+
+void ThumbnailCache::put(const Thumbnail& thumbnail) {
+    entries[thumbnail.name] = thumbnail;
+}
+
+void ThumbnailCache::remove(const std::string& name) {
+    entries.erase(name);
+}
+
+bool ThumbnailCache::readOne(const std::string& filePath, const std::string& name, Thumbnail& thumbnail) {
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<ThumbnailIndexEntry> index;
+    bool found = false;
+    if (readIndex(file, index)) {
+        for (const ThumbnailIndexEntry& entry : index) {
+            if (entry.name == name) {
+                found = readPixels(file, entry, thumbnail);
+                break;
+            }
+        }
+    }
+    std::fclose(file);
+    return found;
+}
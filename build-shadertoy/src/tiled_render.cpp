@@ -0,0 +1,96 @@
+#include "../include/tiled_render.h"
+#include "../include/async_readback.h"
+#include "../include/image_io.h"
+#include "../include/render_target.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+// Tiles waiting for the writer thread on top of the PBO ring
+const size_t TILE_QUEUE_LIMIT = 4;
+
+bool renderTiled(ShaderManager& shader, GLuint quadVAO, const TiledRenderSettings& settings) {
+    GLint maxRenderbuffer = 0;
+    GLint maxViewport[2] = {0, 0};
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    int tileSize = std::max(16, std::min({settings.tileSize, static_cast<int>(maxRenderbuffer),
+                                          static_cast<int>(maxViewport[0]), static_cast<int>(maxViewport[1])}));
+    int tileWidth = std::min(tileSize, settings.width);
+    int tileHeight = std::min(tileSize, settings.height);
+
+    RenderTarget target;
+    if (!target.resize(tileWidth, tileHeight)) {
+        std::cerr << "Tile size " << tileWidth << "x" << tileHeight << " is not supported" << std::endl;
+        return false;
+    }
+    PPMTileWriter writer;
+    if (!writer.open(settings.path, settings.width, settings.height)) {
+        return false;
+    }
+
+    int columns = (settings.width + tileWidth - 1) / tileWidth;
+    int rows = (settings.height + tileHeight - 1) / tileHeight;
+    int tileCount = columns * rows;
+
+    // Tile index -> placement, counted from the image's top-left so the file is written
+    // mostly front to back. Edge tiles are smaller.
+    auto tileRect = [&](int index, int& x, int& y, int& w, int& h) {
+        x = (index % columns) * tileWidth;
+        y = (index / columns) * tileHeight;
+        w = std::min(tileWidth, settings.width - x);
+        h = std::min(tileHeight, settings.height - y);
+    };
+
+    // The readback consumer thread is the writer thread
+    AsyncReadback readback;
+    readback.start([&](ReadbackFrame& frame) {
+        TRACE_SCOPE("tile write");
+        int x, y, w, h;
+        tileRect(static_cast<int>(frame.frameIndex), x, y, w, h);
+        writer.writeTile(x, y, w, h, frame.pixels);
+    }, TILE_QUEUE_LIMIT);
+
+    double tileMiB = tileWidth * static_cast<double>(tileHeight) * 4.0 / (1024.0 * 1024.0);
+    std::cout << "Rendering " << settings.width << "x" << settings.height << " in " << tileCount << " tiles of "
+              << tileWidth << "x" << tileHeight << " to " << settings.path << " (pixel buffers bounded to about "
+              << tileMiB * (READBACK_RING_SIZE + TILE_QUEUE_LIMIT + 1) << " MiB)" << std::endl;
+
+    uint64_t startNs = traceNowNs();
+    uint64_t lastReportNs = startNs;
+    for (int index = 0; index < tileCount; index++) {
+        TRACE_SCOPE("tile");
+        int x, y, w, h;
+        tileRect(index, x, y, w, h);
+        // GL counts rows from the bottom of the virtual image
+        int glY = settings.height - y - h;
+
+        target.bind();
+        glViewport(0, 0, w, h);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        shader.setupShaderToyUniforms(settings.width, settings.height, settings.time, 1.0f / 60.0f,
+                                      static_cast<int>(settings.time * 60.0f), 0, settings.height, false);
+        shader.setupShaderToyTile(x, glY, w, h);
+        glBindVertexArray(quadVAO);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        readback.request(target.getFramebuffer(), w, h, index, std::string());
+        readback.poll();
+
+        uint64_t now = traceNowNs();
+        if (now - lastReportNs > 1000000000ull) {
+            lastReportNs = now;
+            std::cout << "  tile " << index + 1 << "/" << tileCount << std::endl;
+        }
+    }
+    readback.finish();
+    shader.setupShaderToyTile(0, 0, 0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bool ok = writer.close();
+
+    double seconds = (traceNowNs() - startNs) / 1e9;
+    std::cout << (ok ? "Wrote " : "FAILED writing ") << settings.path << ": " << tileCount << " tiles in "
+              << seconds << " s (" << settings.width * static_cast<double>(settings.height) / 1e6 / std::max(seconds, 1e-9)
+              << " MP/s, render thread stalled " << readback.getStallMs() << " ms)" << std::endl;
+    return ok;
+}
@@ -0,0 +1,132 @@
+#include "../include/time_sliced_render.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cmath>
+
+// Tile edge of the first image, before any cost is known
+const int TIME_SLICE_FIRST_TILE = 64;
+const int TIME_SLICE_MIN_TILE = 16;
+const int TIME_SLICE_MAX_TILE = 1024;
+
+TimeSlicedRenderer::TimeSlicedRenderer()
+    : budgetMs(0.0f), pending(0), presentedValid(false), imageDeltaTime(0.0f), imageFrame(0), imageActive(false),
+      imageStartNs(0), tileSize(TIME_SLICE_FIRST_TILE), columns(0), rows(0), nextTile(0), msPerPixel(0.0),
+      imagesCompleted(0), lastImageSeconds(0.0f) {
+}
+
+void TimeSlicedRenderer::setBudgetMs(float value) {
+    budgetMs = std::max(0.0f, value);
+    imageActive = false;
+}
+
+void TimeSlicedRenderer::startImage(const AccumulationInputs& inputs, float deltaTime, int frame) {
+    // The presented image is only worth keeping for the same program at the same size
+    if (presentedInputs.shader != inputs.shader || presentedInputs.program != inputs.program ||
+        presentedInputs.width != inputs.width || presentedInputs.height != inputs.height) {
+        presentedValid = false;
+    }
+    imageInputs = inputs;
+    imageDeltaTime = deltaTime;
+    imageFrame = frame;
+    imageActive = true;
+    imageStartNs = traceNowNs();
+    nextTile = 0;
+
+    // Aim for two tiles per budget so a frame rarely overshoots by a whole tile
+    if (msPerPixel > 0.0) {
+        int edge = static_cast<int>(std::sqrt(budgetMs * 0.5 / msPerPixel));
+        tileSize = std::max(TIME_SLICE_MIN_TILE, std::min(TIME_SLICE_MAX_TILE, edge / 8 * 8));
+    }
+    columns = (inputs.width + tileSize - 1) / tileSize;
+    rows = (inputs.height + tileSize - 1) / tileSize;
+}
+
+bool TimeSlicedRenderer::render(ShaderManager& shader, GLuint quadVAO, const AccumulationInputs& inputs,
+                                float deltaTime, int frame) {
+    if (!isEnabled()) {
+        return false;
+    }
+    // A new program or size makes the image in progress useless; other changes wait for it
+    if (imageActive && (imageInputs.shader != inputs.shader || imageInputs.program != inputs.program ||
+                        imageInputs.width != inputs.width || imageInputs.height != inputs.height)) {
+        imageActive = false;
+    }
+    if (!imageActive) {
+        if (presentedValid && presentedInputs == inputs) {
+            return true;
+        }
+        startImage(inputs, deltaTime, frame);
+        if (!targets[pending].resize(inputs.width, inputs.height)) {
+            imageActive = false;
+            return false;
+        }
+        targets[pending].bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    TRACE_SCOPE("time slice");
+    RenderTarget& target = targets[pending];
+    target.bind();
+    shader.use();
+    shader.setupShaderToyUniforms(imageInputs.width, imageInputs.height, imageInputs.time, imageDeltaTime, imageFrame,
+                                  imageInputs.mouseX, imageInputs.mouseY, imageInputs.mouseDown);
+    shader.setupShaderToyTile(0, 0, 0, 0);
+    shader.setupShaderToyJitter(0.0f, 0.0f);
+    shader.setupShaderToyInterleave(0.0f, 0.0f, 0.0f, 0.0f);
+
+    // Each tile is waited for, so the budget holds for the GPU work and not just the
+    // submission; queued work from earlier in the frame is not charged to the first tile
+    glFinish();
+    uint64_t sliceStartNs = traceNowNs();
+    int firstTile = nextTile;
+    int tileCount = columns * rows;
+    glEnable(GL_SCISSOR_TEST);
+    glBindVertexArray(quadVAO);
+    while (nextTile < tileCount) {
+        // Rows from the top of the image, so it fills in reading order
+        int x = (nextTile % columns) * tileSize;
+        int top = (nextTile / columns) * tileSize;
+        int w = std::min(tileSize, imageInputs.width - x);
+        int h = std::min(tileSize, imageInputs.height - top);
+        uint64_t tileStartNs = traceNowNs();
+        double elapsedMs = (tileStartNs - sliceStartNs) / 1e6;
+        // At least one tile per frame, or a budget below one tile would never finish
+        if (nextTile > firstTile && elapsedMs + msPerPixel * w * h > budgetMs) {
+            break;
+        }
+        glScissor(x, imageInputs.height - top - h, w, h);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glFinish();
+        double tileMs = (traceNowNs() - tileStartNs) / 1e6;
+        double tileMsPerPixel = tileMs / (static_cast<double>(w) * h);
+        msPerPixel = msPerPixel > 0.0 ? msPerPixel * 0.75 + tileMsPerPixel * 0.25 : tileMsPerPixel;
+        nextTile++;
+    }
+    glBindVertexArray(0);
+    glDisable(GL_SCISSOR_TEST);
+
+    if (nextTile == tileCount) {
+        pending = 1 - pending;
+        presentedValid = true;
+        presentedInputs = imageInputs;
+        imageActive = false;
+        imagesCompleted++;
+        lastImageSeconds = static_cast<float>((traceNowNs() - imageStartNs) / 1e9);
+    }
+    return true;
+}
+
+void TimeSlicedRenderer::blitToScreen(int windowWidth, int windowHeight, GLuint screenFramebuffer) const {
+    const RenderTarget& shown = presentedValid ? targets[1 - pending] : targets[pending];
+    if (shown.isValid()) {
+        shown.blitToScreen(windowWidth, windowHeight, screenFramebuffer);
+    }
+}
+
+void TimeSlicedRenderer::release() {
+    targets[0].release();
+    targets[1].release();
+    presentedValid = false;
+    imageActive = false;
+}
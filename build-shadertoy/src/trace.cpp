@@ -0,0 +1,137 @@
+#include "../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Events kept per thread - older events are overwritten once the ring wraps
+const uint32_t TRACE_BUFFER_CAPACITY = 1 << 16;
+
+// One ring slot. sequence is odd while the owner writes the event and 2 * (index + 1)
+// once event number index is complete (a seqlock per slot)
+struct TraceSlot {
+    std::atomic<uint64_t> sequence{0};
+    TraceEvent event;
+};
+
+// Per-thread ring buffer. Only the owning thread writes; the writer publishes
+// with a release store so a reader sees complete events up to writeIndex.
+struct TraceThreadBuffer {
+    TraceSlot slots[TRACE_BUFFER_CAPACITY];
+    std::atomic<uint64_t> writeIndex{0};
+    uint32_t track = 0;
+    TraceThreadBuffer* next = nullptr;
+};
+
+static std::atomic<bool> traceEnabled{false};
+static std::atomic<TraceThreadBuffer*> traceBufferList{nullptr};
+static std::atomic<uint32_t> traceNextTrack{1};
+
+void traceSetEnabled(bool enabled) {
+    traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool traceIsEnabled() {
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+uint64_t traceNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Function to get (and on first use register) the calling thread's buffer
+static TraceThreadBuffer* getThreadBuffer() {
+    thread_local TraceThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new TraceThreadBuffer();
+        buffer->track = traceNextTrack.fetch_add(1);
+        // Lock-free push onto the global list; buffers live until exit
+        buffer->next = traceBufferList.load(std::memory_order_relaxed);
+        while (!traceBufferList.compare_exchange_weak(buffer->next, buffer,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+        }
+    }
+    return buffer;
+}
+
+static void pushEvent(const char* name, const char* category, uint64_t startNs, uint64_t durationNs, uint32_t track) {
+    if (!traceIsEnabled()) {
+        return;
+    }
+    TraceThreadBuffer* buffer = getThreadBuffer();
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    TraceSlot& slot = buffer->slots[index % TRACE_BUFFER_CAPACITY];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.name = name;
+    slot.event.category = category;
+    slot.event.startNs = startNs;
+    slot.event.durationNs = durationNs;
+    slot.event.track = track ? track : buffer->track;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void traceRecord(const char* name, const char* category, uint64_t startNs, uint64_t durationNs) {
+    pushEvent(name, category, startNs, durationNs, 0);
+}
+
+void traceRecordGpu(const char* name, uint64_t startNs, uint64_t durationNs) {
+    pushEvent(name, "gpu", startNs, durationNs, TRACE_GPU_TRACK);
+}
+
+bool traceWriteJson(const std::string& filePath) {
+    // Snapshot every buffer. A thread that keeps recording while we copy can
+    // overwrite the oldest slots; their sequence no longer matches and they are left out.
+    std::vector<TraceEvent> events;
+    std::vector<uint32_t> tracks;
+    for (TraceThreadBuffer* buffer = traceBufferList.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_BUFFER_CAPACITY ? end - TRACE_BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const TraceSlot& slot = buffer->slots[i % TRACE_BUFFER_CAPACITY];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence == 2 * i + 2 && slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                events.push_back(event);
+            }
+        }
+        tracks.push_back(buffer->track);
+    }
+
+    std::FILE* file = std::fopen(filePath.c_str(), "w");
+    if (!file) {
+        std::cerr << "ERROR::TRACE::CANNOT_OPEN_FILE: " << filePath << std::endl;
+        return false;
+    }
+
+    // Timestamps are written relative to the first event
+    uint64_t originNs = UINT64_MAX;
+    for (const TraceEvent& event : events) {
+        originNs = std::min(originNs, event.startNs);
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.startNs < b.startNs;
+    });
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    // Track names
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+                 TRACE_GPU_TRACK);
+    for (uint32_t track : tracks) {
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                     track, track == 1 ? "main" : "worker", track);
+    }
+    for (const TraceEvent& event : events) {
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     event.name, event.category, event.track,
+                     (event.startNs - originNs) / 1000.0, event.durationNs / 1000.0);
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+
+    std::cout << "Trace written to: " << filePath << " (" << events.size() << " events)" << std::endl;
+    return true;
+}
@@ -0,0 +1,179 @@
+#include "../include/video_export.h"
+#include "../include/render_target.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+bool parseVideoFormat(const std::string& name, VideoFormat& format) {
+    if (name == "y4m") {
+        format = VIDEO_Y4M;
+    } else if (name == "raw") {
+        format = VIDEO_RAW;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+VideoWriter::VideoWriter() : file(nullptr), ownsFile(false), failed(false), format(VIDEO_Y4M), bytesWritten(0) {
+}
+
+VideoWriter::~VideoWriter() {
+    close();
+}
+
+bool VideoWriter::open(const VideoExportSettings& settings) {
+    format = settings.format;
+    if (settings.path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        file = stdout;
+        ownsFile = false;
+    } else {
+        file = std::fopen(settings.path.c_str(), "wb");
+        ownsFile = true;
+    }
+    if (!file) {
+        std::cerr << "ERROR::EXPORT::CANNOT_OPEN_FILE: " << settings.path << std::endl;
+        return false;
+    }
+    if (format == VIDEO_Y4M) {
+        // 4:2:0 needs even dimensions
+        if (settings.width % 2 != 0 || settings.height % 2 != 0) {
+            std::cerr << "ERROR::EXPORT::Y4M_NEEDS_EVEN_SIZE" << std::endl;
+            close();
+            return false;
+        }
+        int written = std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420\n",
+                                   settings.width, settings.height, settings.fps);
+        bytesWritten += written > 0 ? written : 0;
+    }
+    return true;
+}
+
+bool VideoWriter::writeFrame(const ReadbackFrame& frame) {
+    if (!file || failed) {
+        return false;
+    }
+    int width = frame.width;
+    int height = frame.height;
+    const unsigned char* rgba = frame.pixels.data();
+    if (format == VIDEO_RAW) {
+        buffer.resize(static_cast<size_t>(width) * height * 3);
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; i++) {
+            buffer[i * 3 + 0] = rgba[i * 4 + 0];
+            buffer[i * 3 + 1] = rgba[i * 4 + 1];
+            buffer[i * 3 + 2] = rgba[i * 4 + 2];
+        }
+    } else {
+        // BT.601 limited range; chroma is the average of each 2x2 block
+        size_t lumaSize = static_cast<size_t>(width) * height;
+        size_t chromaSize = lumaSize / 4;
+        static const char frameHeader[] = "FRAME\n";
+        buffer.resize(sizeof(frameHeader) - 1 + lumaSize + chromaSize * 2);
+        std::copy(frameHeader, frameHeader + sizeof(frameHeader) - 1, buffer.begin());
+        unsigned char* luma = buffer.data() + sizeof(frameHeader) - 1;
+        unsigned char* cb = luma + lumaSize;
+        unsigned char* cr = cb + chromaSize;
+        for (size_t i = 0; i < lumaSize; i++) {
+            int r = rgba[i * 4 + 0], g = rgba[i * 4 + 1], b = rgba[i * 4 + 2];
+            luma[i] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+        for (int y = 0; y < height / 2; y++) {
+            for (int x = 0; x < width / 2; x++) {
+                int r = 0, g = 0, b = 0;
+                for (int dy = 0; dy < 2; dy++) {
+                    const unsigned char* p = rgba + (static_cast<size_t>(y * 2 + dy) * width + x * 2) * 4;
+                    r += p[0] + p[4];
+                    g += p[1] + p[5];
+                    b += p[2] + p[6];
+                }
+                r = (r + 2) / 4;
+                g = (g + 2) / 4;
+                b = (b + 2) / 4;
+                size_t index = static_cast<size_t>(y) * (width / 2) + x;
+                cb[index] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                cr[index] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+    }
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+        std::cerr << "ERROR::EXPORT::WRITE_FAILED (reader closed the pipe?)" << std::endl;
+        failed = true;
+        return false;
+    }
+    bytesWritten += buffer.size();
+    return true;
+}
+
+void VideoWriter::close() {
+    if (file) {
+        std::fflush(file);
+        if (ownsFile) {
+            std::fclose(file);
+        }
+        file = nullptr;
+    }
+}
+
+bool exportVideo(ShaderManager& shader, GLuint quadVAO, const VideoExportSettings& settings) {
+    RenderTarget target;
+    if (!target.resize(settings.width, settings.height)) {
+        std::cerr << "Export size " << settings.width << "x" << settings.height << " is not supported" << std::endl;
+        return false;
+    }
+    VideoWriter writer;
+    if (!writer.open(settings)) {
+        return false;
+    }
+
+    // The readback consumer thread is the writer thread
+    AsyncReadback readback;
+    readback.start([&writer](ReadbackFrame& frame) {
+        TRACE_SCOPE("video write");
+        writer.writeFrame(frame);
+    });
+
+    int frameCount = std::max(1, static_cast<int>(settings.durationSeconds * settings.fps + 0.5f));
+    std::cerr << "Exporting " << frameCount << " frames at " << settings.width << "x" << settings.height
+              << ", " << settings.fps << " fps to " << (settings.path == "-" ? "stdout" : settings.path) << std::endl;
+    uint64_t startNs = traceNowNs();
+    uint64_t lastReportNs = startNs;
+    int frame = 0;
+    for (; frame < frameCount && !writer.hasFailed(); frame++) {
+        TRACE_SCOPE("export frame");
+        target.bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        // Deterministic clock, no input
+        shader.setupShaderToyUniforms(settings.width, settings.height, static_cast<float>(frame) / settings.fps,
+                                      1.0f / settings.fps, frame, 0, settings.height, false);
+        glBindVertexArray(quadVAO);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        readback.request(target.getFramebuffer(), settings.width, settings.height, frame, std::string());
+        readback.poll();
+
+        uint64_t now = traceNowNs();
+        if (now - lastReportNs > 1000000000ull) {
+            lastReportNs = now;
+            std::cerr << "  frame " << frame + 1 << "/" << frameCount << " ("
+                      << (frame + 1) * 1e9 / (now - startNs) << " fps)" << std::endl;
+        }
+    }
+    readback.finish();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    writer.close();
+
+    double seconds = (traceNowNs() - startNs) / 1e9;
+    double achievedFps = seconds > 0.0 ? frame / seconds : 0.0;
+    std::cerr << "Exported " << frame << " frames in " << seconds << " s: " << achievedFps << " fps ("
+              << achievedFps / settings.fps << "x real time, " << writer.getBytesWritten() / (1024 * 1024)
+              << " MiB, render thread stalled " << readback.getStallMs() << " ms)" << std::endl;
+    return !writer.hasFailed();
+}
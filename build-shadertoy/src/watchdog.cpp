@@ -0,0 +1,104 @@
+#include "../include/watchdog.h"
+#include "../include/gpu_timer.h"
+#include <algorithm>
+
+// Frames ignored after a level change, so late GPU timings of the previous
+// level don't count against the new one
+const int WATCHDOG_SETTLE_FRAMES = GPU_TIMER_RING_SIZE + 1;
+
+const char* getDegradeLevelName(DegradeLevel level) {
+    switch (level) {
+        case DEGRADE_NONE: return "full quality";
+        case DEGRADE_RENDER_SCALE: return "reduced render scale";
+        case DEGRADE_LOW_QUALITY: return "low-quality variant";
+        case DEGRADE_FROZEN: return "frozen frame";
+        default: return "unknown";
+    }
+}
+
+FrameWatchdog::FrameWatchdog() : enabled(true) {
+}
+
+FrameWatchdog::ProgramState& FrameWatchdog::getState(int program) {
+    if (program >= static_cast<int>(states.size())) {
+        states.resize(program + 1);
+    }
+    return states[program];
+}
+
+DegradeLevel FrameWatchdog::getLevel(int program) const {
+    if (!enabled || program >= static_cast<int>(states.size())) {
+        return DEGRADE_NONE;
+    }
+    return states[program].level;
+}
+
+bool FrameWatchdog::shouldProbe(int program, float nowSeconds) const {
+    if (!enabled || program >= static_cast<int>(states.size())) {
+        return false;
+    }
+    const ProgramState& state = states[program];
+    return state.level != DEGRADE_NONE && nowSeconds >= state.nextProbeSeconds;
+}
+
+void FrameWatchdog::changeLevel(int program, const std::string& programName, DegradeLevel newLevel,
+                                float costMs, float nowSeconds, const char* reason) {
+    ProgramState& state = getState(program);
+    std::cout << "Watchdog: " << programName << " " << getDegradeLevelName(state.level)
+              << " -> " << getDegradeLevelName(newLevel) << " (" << reason;
+    if (costMs >= 0.0f) {
+        std::cout << ", " << costMs << " ms vs budget " << config.budgetMs << " ms";
+    }
+    std::cout << ")" << std::endl;
+
+    state.level = newLevel;
+    state.overCount = 0;
+    state.settleFrames = WATCHDOG_SETTLE_FRAMES;
+    state.nextProbeSeconds = nowSeconds + state.probeIntervalSeconds;
+}
+
+void FrameWatchdog::reportFrame(int program, const std::string& programName, DegradeLevel renderedLevel,
+                                bool probe, float costMs, float nowSeconds) {
+    if (!enabled) {
+        return;
+    }
+    ProgramState& state = getState(program);
+
+    if (probe) {
+        // A probe decides on its own: step up on headroom, otherwise back off
+        if (costMs < config.budgetMs * config.recoverFraction) {
+            state.recoveredSeconds = nowSeconds;
+            changeLevel(program, programName, renderedLevel, costMs, nowSeconds, "probe has headroom");
+        } else {
+            state.probeIntervalSeconds = std::min(state.probeIntervalSeconds * 2.0f, config.maxProbeIntervalSeconds);
+            state.nextProbeSeconds = nowSeconds + state.probeIntervalSeconds;
+        }
+        return;
+    }
+
+    if (renderedLevel != state.level) {
+        return;
+    }
+    if (state.settleFrames > 0) {
+        state.settleFrames--;
+        return;
+    }
+
+    if (costMs > config.budgetMs) {
+        state.overCount++;
+        if (state.overCount >= config.overBudgetFrames && state.level + 1 < DEGRADE_LEVEL_COUNT) {
+            // Relapsing right after a recovery means the probe was too optimistic,
+            // a long stable stretch starts the backoff over
+            if (state.probeIntervalSeconds <= 0.0f ||
+                nowSeconds - state.recoveredSeconds > config.maxProbeIntervalSeconds * 4.0f) {
+                state.probeIntervalSeconds = config.probeIntervalSeconds;
+            } else if (nowSeconds - state.recoveredSeconds < config.relapseSeconds) {
+                state.probeIntervalSeconds = std::min(state.probeIntervalSeconds * 2.0f, config.maxProbeIntervalSeconds);
+            }
+            changeLevel(program, programName, static_cast<DegradeLevel>(state.level + 1), costMs, nowSeconds,
+                        "over budget");
+        }
+    } else {
+        state.overCount = 0;
+    }
+}